@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+# packs the game assets into one file that the game memory maps
+
+import sys
+import os
+import struct
+import argparse
+
+MAGIC = b'HOPA'
+VERSION = 1
+# magic, version, flags, entry_count, index_offset, names_offset, names_size
+HEADER_FORMAT = '<4sHHIIII'
+# hash, name_offset, name_len, data_offset, data_size
+ENTRY_FORMAT = '<QIIII'
+DATA_ALIGN = 16
+# levels are memory mapped on their own and can be hot reloaded
+DEFAULT_EXCLUDES = ['levels']
+
+FNV_OFFSET = 0xcbf29ce484222325
+FNV_PRIME = 0x100000001b3
+
+
+def fnv1a(data):
+    """64 bit FNV-1a, must match hashAssetName in asset_pack.cpp"""
+    value = FNV_OFFSET
+    for byte in data:
+        value ^= byte
+        value = (value * FNV_PRIME) & 0xffffffffffffffff
+    return value
+
+
+def find_assets(root, excludes):
+    """relative paths of every file under root, using / as the separator"""
+    assets = []
+    for dir_path, dir_names, file_names in os.walk(root):
+        rel_dir = os.path.relpath(dir_path, root)
+        dir_names[:] = sorted(name for name in dir_names
+                              if os.path.normpath(os.path.join(rel_dir, name)) not in excludes)
+        for name in sorted(file_names):
+            if name.startswith('.'):
+                continue
+            rel_path = os.path.normpath(os.path.join(rel_dir, name))
+            assets.append(rel_path.replace(os.sep, '/'))
+    return assets
+
+
+def align(offset):
+    return (offset + DATA_ALIGN - 1) & ~(DATA_ALIGN - 1)
+
+
+def pack_assets(root, out_file, excludes):
+    assets = find_assets(root, excludes)
+    names = bytearray()
+    entries = []
+    seen = {}
+    for rel_path in assets:
+        encoded = rel_path.encode('utf-8')
+        name_hash = fnv1a(encoded)
+        if name_hash in seen:
+            raise ValueError('{0} and {1} have the same hash'.format(seen[name_hash], rel_path))
+        seen[name_hash] = rel_path
+        entries.append([name_hash, len(names), len(encoded), rel_path])
+        names += encoded
+
+    # index sorted by hash so the game can binary search it
+    entries.sort(key=lambda entry: entry[0])
+    header_size = struct.calcsize(HEADER_FORMAT)
+    index_offset = header_size
+    names_offset = index_offset + len(entries) * struct.calcsize(ENTRY_FORMAT)
+    data_offset = align(names_offset + len(names))
+
+    index = bytearray()
+    data = bytearray()
+    for name_hash, name_offset, name_len, rel_path in entries:
+        with open(os.path.join(root, rel_path), 'rb') as asset_file:
+            contents = asset_file.read()
+        offset = data_offset + len(data)
+        index += struct.pack(ENTRY_FORMAT, name_hash, name_offset, name_len, offset, len(contents))
+        data += contents
+        data += bytes(align(len(data)) - len(data))
+
+    with open(out_file, 'wb') as pack_file:
+        pack_file.write(struct.pack(HEADER_FORMAT, MAGIC, VERSION, 0, len(entries),
+                                    index_offset, names_offset, len(names)))
+        pack_file.write(index)
+        pack_file.write(names)
+        pack_file.write(bytes(data_offset - names_offset - len(names)))
+        pack_file.write(data)
+    print('{0} -> {1} ({2} assets, {3} bytes)'.format(root, out_file, len(entries), data_offset + len(data)))
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("assets", help="Assets directory to pack")
+    parser.add_argument("pack", help="Pack file to write")
+    parser.add_argument("--exclude", action='append', default=None,
+                        help="Directory under assets to leave out, can be repeated. Defaults to levels")
+    args = parser.parse_args()
+
+    excludes = [os.path.normpath(path) for path in (args.exclude or DEFAULT_EXCLUDES)]
+    try:
+        pack_assets(args.assets, args.pack, excludes)
+    except (OSError, ValueError) as ex:
+        print('Failed to pack {0}: {1}'.format(args.assets, ex))
+        sys.exit(1)
@@ -1,6 +1,6 @@
 //
 //  BeingType.h
-//  type class for Beings
+//  types of Beings, loaded from a data file
 //
 //  Created by Vande Griek, Eric on 3/1/18.
 //  Copyright © 2018 Vande Griek, Eric. All rights reserved.
@@ -9,10 +9,13 @@
 #ifndef being_type_h
 #define being_type_h
 
-#include <map>
 #include <string>
+#include <vector>
 #include "SDL.h"
 #include "sprite.h"
+#include "resource_manager.h"
+
+constexpr auto BEING_TYPES_FILE = "./Assets/beings.txt";
 
 /**
  types of automated actions that beings can exhibit
@@ -23,13 +26,13 @@ enum class ActionType {
     JUMP_AROUND,
 };
 
-class BeingType {
-private:
-public:
-    // static functions to return the instance of each type
-    static BeingType& player();
-    static BeingType& redEnemy();
-    static BeingType& blueEnemy();
+/**
+ What every being of one type has in common.
+ Never changed once loaded, beings point at their type instead of copying it.
+ */
+struct BeingType {
+    std::string name;
+    int tile_num; // placed in levels with this tile number
 
     // game properties
     int hp;
@@ -42,7 +45,7 @@ public:
     // phsical
     int width;
     int height;
-    std::string sprite_sheet;
+    ImageId sprite_sheet;
     FrameConfig frame_config;
     int pad_top;
     int pad_right;
@@ -55,14 +58,31 @@ public:
     int max_air_jumps;
     
     // sounds
-    std::string walk_sound;
-    std::string jump_sound;
-    std::string landed_sound;
-    std::string damaged_sound;
-    std::string death_sound;
+    SoundId walk_sound;
+    SoundId jump_sound;
+    SoundId landed_sound;
+    SoundId damaged_sound;
+    SoundId death_sound;
     
     // callbacks
     ActionType action_type;
 };
 
+/**
+ Every type of being, read from a data file.
+ Sprite sheets and sounds are turned into handles as the file is read,
+ so creating a being doesn't copy or look up anything by name.
+ */
+class BeingRegistry {
+private:
+    std::vector<BeingType> types; // only filled by load(), so pointers into it stay valid
+    int tile_types[UINT8_MAX + 1]; // index into types by tile number, -1 if the tile isn't a being
+public:
+    BeingRegistry();
+    void load(const std::string &filename);
+    const BeingType* forTile(int tile_num) const;
+    /** Get the number of types */
+    int count() const { return int(types.size()); }
+};
+
 #endif /* player_h */
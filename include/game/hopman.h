@@ -12,21 +12,28 @@
 #include <iostream>
 #include <vector>
 #include <set>
+#include <map>
 #include <tuple>
 #include <string>
 #include <fstream>
 #include <sstream>
 #include "frame_timer.h"
+#include "scheduler.h"
 #include "graphics.h"
 #include "audio.h"
+#include "particles.h"
+#include "file_watcher.h"
 #include "input.h"
 #include "gui.h"
 #include "menu.h"
 #include "gui_element.h"
 #include "resource_manager.h"
-#include "drawable.h"
-#include "being.h"
+#include "world.h"
+#include "systems.h"
 #include "tile.h"
+#include "level_config.h"
+#include "level_streamer.h"
+#include "level_preloader.h"
 #include "background.h"
 
 constexpr int STARTING_LEVEL = 1;
@@ -35,13 +42,50 @@ constexpr auto BG_TRACK = "bg_track.mp3";
 constexpr int DEFAULT_FPS_LIMIT = 60;
 constexpr int DEFAULT_WINDOW_WIDTH = 1280;
 constexpr int DEFAULT_WINDOW_HEIGHT = 720;
+// the world is drawn at 1/N of the window size and upscaled, 1 draws at full size
+// the art is 16px sprites drawn as 32px tiles, so 2 loses no detail
+constexpr int WORLD_RENDER_DIVISOR = 2;
 
 constexpr int UI_FONT_SIZE = 24;
 
+// how often each subsystem runs in ms, 0 runs every frame,
+// and how long one run should take at most
+constexpr int AI_INTERVAL_MS = 0; // each run only thinks for 1 in AI_SLICES enemies
+constexpr float AI_BUDGET_MS = 0.5f;
+constexpr int PHYSICS_INTERVAL_MS = 0;
+constexpr float PHYSICS_BUDGET_MS = 2.0f;
+constexpr int ANIMATION_INTERVAL_MS = 40; // sprite frames only change every TICKS_PER_FRAME
+constexpr float ANIMATION_BUDGET_MS = 0.5f;
+constexpr int EMITTER_INTERVAL_MS = 50;
+constexpr float EMITTER_BUDGET_MS = 0.25f;
+constexpr int PARTICLE_INTERVAL_MS = 0;
+constexpr float PARTICLE_BUDGET_MS = 1.0f;
+constexpr int GUI_INTERVAL_MS = 100;
+constexpr float GUI_BUDGET_MS = 1.0f;
+
+constexpr auto LEVEL_DIR = "./Assets/levels/";
 constexpr auto LEVEL_FILE_PREFIX = "./Assets/levels/level_";
 
 constexpr int DEFAULT_EXTRA_LIVES = 2;
 
+/**
+ One layer of the level background
+ */
+struct BgLayerConfig {
+    const char *img_file;
+    int distance;
+};
+
+constexpr int BG_COLOR[3] = {125, 90, 125};
+constexpr BgLayerConfig BG_LAYERS[] = {
+    {"background/dusk/layer_0.png", 60},
+    {"background/dusk/layer_1.png", 30},
+    {"background/dusk/layer_2.png", 20},
+    {"background/dusk/layer_3.png", 16},
+    {"background/dusk/layer_4.png", 6},
+    {"background/dusk/layer_5.png", 2},
+};
+
 constexpr int PAUSE_MENU_WIDTH = 500;
 constexpr int PAUSE_MENU_HEIGHT = 500;
 constexpr int PAUSE_MENU_TOP_PAD = 50;
@@ -69,6 +113,17 @@ static std::string LIVES_STR = "Lives: ";
 static std::string LEVEL_STR = "Level: ";
 static std::string FPS_STR = "FPS: ";
 
+/**
+ Where a being was placed when it was created, so it can be put back on respawn
+ */
+struct BeingSpawn {
+    EntityId entity; // stale once it has been removed from the world
+    int tile_type;
+    int x_pos;
+    int y_pos;
+    bool parked; // removed with a chunk that was unloaded, placed again when its chunk loads
+};
+
 enum class GameState {
     LEVEL_START,
     PLAYING,
@@ -78,13 +133,6 @@ enum class GameState {
     LEVEL_WON,
 };
 
-/**
- Structure to hold config from level config files
- */
-struct LevelConfig {
-    std::vector<std::vector<int>> tiles;
-};
-
 /**
  Main class for the Hopman platformer
  Most of the game logic is handled by this class.
@@ -97,24 +145,50 @@ private:
     int fps_limit;
     int score;
     int lives;
+    /** reload assets when they change on disk */
+    bool hot_reload;
+    /** seed of the whole run, the seed of each level comes from it */
+    Uint32 seed;
 
     int fps_display;
     std::string game_message;
 
-    Being player;
+    EntityId player;
     Background background;
-    std::vector<Drawable*> objects;
+    World world;
+    /** what each type of being is like, shared by the beings of the type */
+    BeingRegistry being_types;
+    /** every being created for the level, including ones that have been removed from the world */
+    std::vector<BeingSpawn> beings;
+    /** where each being in the roster is, by its tile number and tile coordinates */
+    std::map<std::tuple<int, int, int>, size_t> being_placements;
+    LevelConfig level_config;
+    /** creates the tiles in the world as the view gets near */
+    LevelStreamer streamer;
+    /** loads the next level while the win screen is up */
+    LevelPreloader preloader;
+    /** chunks around the start of the preloaded level, added to the world when it is built */
+    std::vector<Chunk> preloaded_chunks;
     /** player dies if they fall past here */
     int lower_bound;
+    /** runs the systems of the world while playing */
+    Scheduler systems;
+    /** runs the rest of the frame work, whether playing or not */
+    Scheduler frame_tasks;
+    /** which enemies the next AI run thinks for */
+    int ai_slice;
 
     /** set game state to start quitting */
     void exitGame() { game_state = GameState::EXITING; }
     void toggleFps();
+    void logMemoryReport();
+    void logTimingReport();
     void pause();
     
     void handleInput();
     void advanceScreen();
     void registerInputCallbacks();
+    void scheduleSystems();
     void update(int delta);
     void render();
     void renderGui();
@@ -126,19 +200,28 @@ private:
     void createGameMessage();
     void setGameMessage(std::string new_msg);
     
-    bool checkRemoval(Drawable *obj);
     void removeDestroyed();
     void tryRespawn();
     void restartGame();
     void cleanupLevel();
-    void hitGoal(Drawable &other);
+    void hitGoal(EntityId other);
 
     void parseLevelConfig(LevelConfig &config);
+    void preloadNextLevel();
     void setupLevel();
+    void buildLevel();
+    void preloadLevelAssets();
+    void restoreLevel();
     void createBackground();
-    void add_tile(int tile_type, int tx, int ty);
+    void applyAssetChanges();
+    bool reloadLevelFile(const std::string &path);
+    void addBeing(int tile_type, int tx, int ty);
+    void parkBeings(const SDL_Rect &rect);
+    EntityId spawnBeing(const BeingSpawn &spawn);
+    /** Get the box the player takes up in the world */
+    const SDL_Rect& playerRect() { return world.colliders.get(player).box; }
 public:
-    void init();
+    void init(bool hot_reload = false, const AudioConfig &audio_config = AudioConfig(), Uint32 seed = 0);
     void shutdown();
     int play();
 };
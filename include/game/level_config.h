@@ -0,0 +1,100 @@
+//
+//  level_config.h
+//  Loads level files in the text or compiled binary format
+//
+//  Copyright © 2018 Vande Griek, Eric. All rights reserved.
+//
+
+#ifndef level_config_h
+#define level_config_h
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <exception>
+#include "SDL.h"
+
+constexpr auto LEVEL_BIN_SUFFIX = ".bin";
+constexpr char LEVEL_BIN_MAGIC[4] = {'H', 'O', 'P', 'L'};
+constexpr Uint16 LEVEL_BIN_VERSION = 1;
+
+/**
+ Header at the start of a compiled level file.
+ All fields are little endian.
+ The tiles follow the header as one byte per tile, row by row.
+ */
+struct LevelFileHeader {
+    char magic[4];
+    Uint16 version;
+    Uint16 flags; // reserved
+    Uint32 width;
+    Uint32 height;
+    Uint32 entity_count;
+    Uint32 entity_offset; // from the start of the file
+};
+static_assert(sizeof(LevelFileHeader) == 24, "LevelFileHeader must match the file layout");
+
+/**
+ Something placed in a level outside of the tile grid, such as the player or an enemy.
+ type is a TileNum.
+ */
+struct LevelEntity {
+    Uint32 tx;
+    Uint32 ty;
+    Uint8 type;
+    Uint8 pad[3];
+};
+static_assert(sizeof(LevelEntity) == 12, "LevelEntity must match the file layout");
+
+/**
+ The contents of a level file.
+ Tiles are stored flat, one byte per tile.
+ Compiled levels are memory mapped and read in place until the config is destroyed.
+ */
+class LevelConfig {
+private:
+    int width;
+    int height;
+    const Uint8 *tiles;
+    int entity_count;
+    const Uint8 *entities; // packed LevelEntity records, may be unaligned
+    bool tile_used[UINT8_MAX + 1]; // which tile numbers appear in the level
+    std::string filename;
+
+    /** backing storage when the level was parsed from text */
+    std::vector<Uint8> tile_storage;
+    void *map_addr;
+    size_t map_len;
+
+    void mapFile(const std::string &filename);
+    void unload();
+public:
+    LevelConfig();
+    ~LevelConfig();
+    LevelConfig(const LevelConfig&) = delete;
+    LevelConfig& operator=(const LevelConfig&) = delete;
+
+    void loadText(const std::string &filename);
+    void loadBinary(const std::string &filename);
+    void swap(LevelConfig &other);
+
+    /** Get the file the level was loaded from */
+    const std::string& getFilename() const { return filename; }
+    /** Width of the level in tiles */
+    int getWidth() const { return width; }
+    /** Height of the level in tiles */
+    int getHeight() const { return height; }
+    /** Get the TileNum at the given tile coordinates */
+    int tileAt(int tx, int ty) const { return tiles[ty * width + tx]; }
+    /** True if the tile number appears anywhere in the level */
+    bool usesTile(int tile_num) const { return tile_used[tile_num]; }
+    /** Number of entities stored outside of the tile grid */
+    int getEntityCount() const { return entity_count; }
+    LevelEntity getEntity(int idx) const;
+    bool findTile(int tile_num, int &tx, int &ty) const;
+};
+
+std::string findLevelFile(const std::string &prefix, int level, bool &compiled);
+void benchmarkLevelLoading(const std::string &filename, int iterations);
+
+#endif /* level_config_h */
@@ -0,0 +1,56 @@
+//
+//  level_generator.h
+//  Generates random levels from a seed for stress and scale testing
+//
+//  Copyright © 2018 Vande Griek, Eric. All rights reserved.
+//
+
+#ifndef level_generator_h
+#define level_generator_h
+
+#include <string>
+#include <vector>
+#include "SDL.h"
+#include "tile.h"
+
+constexpr int GEN_MIN_WIDTH = 8;
+constexpr int GEN_MIN_HEIGHT = 6;
+constexpr int GEN_SAFE_COLUMNS = 4; // no hazards or enemies this close to the player and goal
+constexpr int GEN_PLATFORM_MIN_LEN = 3;
+constexpr int GEN_PLATFORM_MAX_LEN = 8;
+constexpr int GEN_PLATFORM_ROW_GAP = 3; // rows of air between rows that can hold platforms
+
+constexpr float GEN_DEFAULT_PLATFORM_DENSITY = 0.05f;
+constexpr float GEN_DEFAULT_ENEMY_DENSITY = 0.02f;
+constexpr float GEN_DEFAULT_HAZARD_DENSITY = 0.05f;
+
+/**
+ Settings for generating a level.
+ Densities are chances from 0 to 1:
+ platform_density per tile of a platform starting there,
+ enemy_density per open tile on top of the ground or a platform,
+ hazard_density per ground tile of being fire instead.
+ */
+struct LevelGenParams {
+    Uint32 seed = 1;
+    int width = 200;
+    int height = 30;
+    float platform_density = GEN_DEFAULT_PLATFORM_DENSITY;
+    float enemy_density = GEN_DEFAULT_ENEMY_DENSITY;
+    float hazard_density = GEN_DEFAULT_HAZARD_DENSITY;
+};
+
+/**
+ A level made by generateLevel, one TileNum per tile row by row
+ */
+struct GeneratedLevel {
+    int width;
+    int height;
+    std::vector<Uint8> tiles;
+
+    void saveText(const std::string &filename) const;
+};
+
+GeneratedLevel generateLevel(const LevelGenParams &params);
+
+#endif /* level_generator_h */
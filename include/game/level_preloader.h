@@ -0,0 +1,61 @@
+//
+//  level_preloader.h
+//  Loads the next level in the background while the win screen is up
+//
+//  Copyright © 2018 Vande Griek, Eric. All rights reserved.
+//
+
+#ifndef level_preloader_h
+#define level_preloader_h
+
+#include <string>
+#include <vector>
+#include <set>
+#include <utility>
+#include <thread>
+#include <atomic>
+#include "SDL.h"
+#include "level_config.h"
+#include "resource_manager.h"
+#include "tile.h"
+#include "level_streamer.h"
+
+/**
+ Reads a level file, decodes the images it needs and lists the chunks around where the player starts
+ on a worker thread.
+ The main thread takes the result once it is ready and only has to upload the images
+ and add the chunks to the world.
+ */
+class LevelPreloader {
+private:
+    std::thread worker;
+    std::atomic<bool> done{false};
+    int level = -1; // level being loaded, -1 if nothing is
+    std::string level_prefix;
+    std::vector<std::string> extra_images;
+    std::set<std::string> loaded_images; // already loaded, not decoded again
+    int view_w = 0;
+    int view_h = 0;
+
+    // filled in by the worker
+    LevelConfig config;
+    std::string filename;
+    double load_ms = 0;
+    std::vector<std::pair<std::string, SDL_Surface*>> images;
+    std::vector<Chunk> chunks;
+    std::string error;
+
+    void load();
+    void freeImages();
+public:
+    LevelPreloader();
+    ~LevelPreloader();
+    void start(const std::string &prefix, int level, const std::vector<std::string> &image_names,
+               const std::set<std::string> &loaded_images, int view_w, int view_h);
+    bool take(int level, LevelConfig &out, std::vector<Chunk> &start_chunks);
+    void cancel();
+    /** True once the level being preloaded is ready to take */
+    bool isReady() { return level >= 0 && done; }
+};
+
+#endif /* level_preloader_h */
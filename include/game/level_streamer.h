@@ -0,0 +1,148 @@
+//
+//  level_streamer.h
+//  Loads and unloads the tiles of a level in chunks around the view
+//
+//  Copyright © 2018 Vande Griek, Eric. All rights reserved.
+//
+
+#ifndef level_streamer_h
+#define level_streamer_h
+
+#include <vector>
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "SDL.h"
+#include "world.h"
+#include "tile.h"
+#include "level_config.h"
+#include "graphics.h"
+#include "object_pool.h"
+
+constexpr int CHUNK_TILES = 16; // chunks are this many tiles on a side
+constexpr int CHUNK_SIDE = CHUNK_TILES * TILE_SIDE;
+constexpr int CHUNK_LOAD_MARGIN = 1; // chunks this far outside the view are loaded
+constexpr int CHUNK_EVICT_MARGIN = 2; // chunks further than this outside the view are unloaded
+constexpr size_t CHUNK_POOL_BLOCK = 32; // chunks are allocated this many at a time
+constexpr size_t CHUNK_SPARE_TEXTURES = 8; // textures of unloaded chunks kept to bake new ones into
+
+/**
+ Where a chunk is in its lifetime.
+ Empty chunks have no tiles or beings in them and are never stored.
+ */
+enum ChunkState : Uint8 {
+    CHUNK_UNLOADED = 0,
+    CHUNK_PENDING = 1,
+    CHUNK_LOADED = 2,
+    CHUNK_EMPTY = 3,
+    CHUNK_STATE_MASK = 0x7F,
+    CHUNK_SPAWNED = 0x80, // flag set while the beings placed in the chunk have been created
+};
+
+/**
+ A tile placed in a chunk, in world pixels
+ */
+struct ChunkTile {
+    int x_pos;
+    int y_pos;
+    Uint8 tile_num;
+};
+
+/**
+ The tiles of one square section of a level.
+ Built on the worker thread, baked and added to the world on the main thread.
+ Chunks are pooled, their vectors keep their capacity from one use to the next.
+ */
+struct Chunk {
+    int index;
+    int generation; // level load the chunk was built for
+    std::vector<ChunkTile> tiles;
+    std::vector<EntityId> entities; // of the tiles, once the chunk is in the world
+    std::vector<LevelEntity> spawns; // beings placed in the tile grid
+    SDL_Texture *texture = NULL; // every tile drawn into one texture
+    SDL_Rect rect; // in world pixels
+};
+
+/**
+ Streams a level in and out chunk by chunk as the view moves.
+ Only chunks near the view have tile entities, so memory and setup cost
+ don't grow with the size of the level.
+ */
+class LevelStreamer {
+private:
+    LevelConfig *config = NULL;
+    int chunks_w = 0;
+    int chunks_h = 0;
+    std::vector<Uint8> chunk_states; // ChunkState per chunk, one byte each
+    std::unordered_map<int, Chunk*> loaded;
+    /** beings stored outside the tile grid, sorted by chunk index */
+    std::vector<LevelEntity> chunk_entities;
+    std::vector<int> entity_starts; // first of each chunk's beings in chunk_entities, plus one past the end
+    SDL_Texture *tile_textures[UINT8_MAX + 1];
+    std::vector<SDL_Texture*> spare_textures; // full size chunk textures that aren't in use
+
+    // chunks are built on both threads
+    ObjectPool<Chunk, CHUNK_POOL_BLOCK> chunk_pool;
+    std::mutex pool_mutex;
+
+    std::function<void(int, int, int)> spawn_callback;
+    std::function<void(const SDL_Rect&)> despawn_callback;
+
+    // shared with the worker thread
+    std::thread worker;
+    std::mutex queue_mutex;
+    std::condition_variable queue_cond;
+    std::condition_variable idle_cond; // signalled when the worker finishes a chunk
+    std::deque<std::pair<int, int>> requests; // chunk index and generation
+    std::deque<Chunk*> ready;
+    int generation = 0;
+    bool stopping = false;
+    bool busy = false; // worker is building a chunk
+
+    void workerLoop();
+    void resolveTextures(const LevelConfig &level_config);
+    void cancelPending();
+    Chunk* buildChunk(int index, int chunk_generation);
+    void integrate(Chunk *chunk, World &world);
+    void bake(Chunk *chunk);
+    void evict(const std::vector<Chunk*> &chunks, World &world, bool despawn);
+    Chunk* newChunk();
+    void deleteChunk(Chunk *chunk);
+    SDL_Rect chunkRange(const SDL_Rect &view, int margin);
+    /** Get the state of a chunk without its flags */
+    ChunkState stateOf(int index) { return ChunkState(chunk_states[index] & CHUNK_STATE_MASK); }
+    /** Set the state of a chunk, keeping its flags */
+    void setState(int index, ChunkState state) {
+        chunk_states[index] = (chunk_states[index] & ~CHUNK_STATE_MASK) | state;
+    }
+public:
+    LevelStreamer();
+    ~LevelStreamer();
+    void init();
+    void shutdown();
+    void start(LevelConfig &level_config, std::function<void(int, int, int)> spawn_callback,
+               std::function<void(const SDL_Rect&)> despawn_callback);
+    void clear(World &world);
+    void update(const SDL_Rect &view, World &world, bool blocking);
+    void addChunks(std::vector<Chunk> &chunks, World &world);
+    static void listChunk(const LevelConfig &level_config, int index, Chunk &chunk);
+    static std::vector<int> chunksAround(const LevelConfig &level_config, const SDL_Rect &view);
+    void render();
+    bool isSettled(const SDL_Rect &rect);
+    bool isChunkLoaded(int x_pos, int y_pos);
+    void reload(LevelConfig &fresh, World &world);
+    void rebake();
+    /** Get the number of chunks that currently have tile entities */
+    int loadedCount() { return int(loaded.size()); }
+    size_t bakedBytes();
+    /** Get the number of textures kept to bake chunks into */
+    int spareTextureCount() { return int(spare_textures.size()); }
+    size_t pooledCount();
+    int maxLoadedTiles(const SDL_Rect &view);
+};
+
+#endif /* level_streamer_h */
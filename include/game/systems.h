@@ -0,0 +1,75 @@
+//
+//  systems.h
+//  Systems that update and draw the entities of the world
+//
+//  Copyright © 2018 Vande Griek, Eric. All rights reserved.
+//
+
+#ifndef systems_h
+#define systems_h
+
+#include <vector>
+#include <queue>
+#include "SDL.h"
+#include "world.h"
+#include "tile.h"
+#include "level_streamer.h"
+#include "audio.h"
+#include "particles.h"
+#include "graphics.h"
+
+constexpr float GRAVITY = 500 / 1000.0f / 1000.0f;
+constexpr float TERMINAL_VELOCITY = 1500 / 1000.0f;
+constexpr float FRICTION = 800 / 1000.0f / 1000.0f;
+
+constexpr float BEING_DEATH_DELAY_MS = 1500; // keep dead enemies on the screen for this long
+constexpr int JUMP_TOLERANCE_MS = 200; // can jump has touched ground in the last X milliseconds
+constexpr int WALK_SOUND_INTERVAL_MS = 300; // play the walk sound every x ms while walking
+constexpr int AI_SLICES = 8; // each AI update only thinks for 1 in N enemies
+
+constexpr float MOVE_ACCEL = 500 / 1000.0f / 1000.0f;
+constexpr float CORRECTION_ACCEL = 200 / 1000.0f / 1000.0f;
+constexpr float JUMP_VELOCITY = 250 / 1000.0f;
+
+constexpr int LANDING_DUST_PARTICLES = 8;
+constexpr int DAMAGE_SPARK_PARTICLES = 12;
+constexpr int DEATH_BURST_PARTICLES = 48;
+
+enum class Axis {
+    X,
+    Y,
+};
+
+/**
+ Struct used during collision detection
+ Defines < operator based on time, so it can be stored in priority queue
+ */
+struct CollisionRecord {
+    Axis axis;
+    float time;
+    float diff;
+    EntityId other;
+
+    /** Comparison operator so records can be sorted by the time they occurred */
+    bool operator<(const CollisionRecord &rhs) const { return time > rhs.time; }
+};
+
+// systems, each runs over the entities that have the components it needs
+void updateFrozen(World &world, LevelStreamer &streamer);
+void updateAi(World &world, int slice = 0, int slices = 1);
+void updatePhysics(World &world, int delta);
+void updateCollisions(World &world);
+void updateLifetimes(World &world, int lower_bound);
+void updateSprites(World &world);
+void updateEmitters(World &world, int delta);
+void renderSprites(World &world);
+
+// controls for a being
+bool isDead(World &world, EntityId entity);
+void jumpBeing(World &world, EntityId entity);
+void moveBeingRight(World &world, EntityId entity);
+void stopBeingRight(World &world, EntityId entity);
+void moveBeingLeft(World &world, EntityId entity);
+void stopBeingLeft(World &world, EntityId entity);
+
+#endif /* systems_h */
@@ -1,6 +1,6 @@
 //
 //  tile.h
-//  Tile that makes up the structure of a level
+//  Tiles that make up the structure of a level
 //
 //  Created by Vande Griek, Eric on 3/1/18.
 //  Copyright © 2018 Vande Griek, Eric. All rights reserved.
@@ -10,9 +10,9 @@
 #define tile_h
 
 #include <vector>
+#include <string>
 #include "SDL.h"
-#include "drawable.h"
-#include "graphics.h"
+#include "resource_manager.h"
 
 constexpr int TILE_SIDE = 32;
 
@@ -20,6 +20,7 @@ constexpr auto TEXTURE_PREFIX = "tiles/tile_";
 constexpr auto TEXTURE_SUFFIX = ".png";
 
 constexpr int DAMAGE_TILE_DAMAGE = 1;
+constexpr int EMBER_INTERVAL_MS = 150; // fire tiles give off an ember this often while on screen
 
 // these should be in a config file so they can be shared with the level creator
 /**
@@ -37,16 +38,12 @@ enum TileNum {
     BLUE_ENEMY = 7,
 };
 
-/**
- Class representing one tile in the grid of tiles that makes up a level
- */
-class Tile : public Drawable {
-private:
-    int tile_num;
-public:
-    Tile(int tile_num);
-    void update(int delta, std::vector<Drawable*> &objects) override;
-    void render() override;
-};
+/** True for tile numbers that place a being rather than a tile */
+inline bool isBeingTile(int tile_num) {
+    return tile_num == TileNum::PLAYER || tile_num == TileNum::RED_ENEMY || tile_num == TileNum::BLUE_ENEMY;
+}
+
+std::string tileTextureName(int tile_num);
+SDL_Texture* tileTextureFor(int tile_num);
 
 #endif /* tile_h */
@@ -0,0 +1,278 @@
+//
+//  world.h
+//  Entities of a level and the components that describe them
+//
+//  Copyright © 2018 Vande Griek, Eric. All rights reserved.
+//
+
+#ifndef world_h
+#define world_h
+
+#include <vector>
+#include <functional>
+#include "SDL.h"
+#include "sprite.h"
+#include "being_type.h"
+#include "resource_manager.h"
+#include "xorshift.h"
+
+/**
+ An entity is only a handle, everything about it is stored in component arrays.
+ The low bits are an index into the sparse tables, the high bits a generation that goes up
+ each time the index is reused, so a handle kept after its entity is removed never refers
+ to the entity that gets the index next.
+ */
+typedef Uint32 EntityId;
+constexpr int ENTITY_INDEX_BITS = 20;
+constexpr Uint32 ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+constexpr Uint32 ENTITY_GENERATION_MASK = (1u << (32 - ENTITY_INDEX_BITS)) - 1;
+constexpr Uint32 MAX_ENTITIES = ENTITY_INDEX_MASK; // the last index is never used so NO_ENTITY can't be valid
+constexpr EntityId NO_ENTITY = UINT32_MAX;
+
+/** Get the index of an entity in the sparse tables */
+inline Uint32 entityIndex(EntityId entity) { return entity & ENTITY_INDEX_MASK; }
+/** Get the generation of the index an entity was made with */
+inline Uint32 entityGeneration(EntityId entity) { return entity >> ENTITY_INDEX_BITS; }
+/** Get the handle for an index at a generation, the generation wraps around */
+inline EntityId makeEntity(Uint32 index, Uint32 generation) { return (generation << ENTITY_INDEX_BITS) | index; }
+
+/**
+ Collider flags, what happens to things that run into an entity
+ */
+enum ColliderFlags : Uint8 {
+    COLLIDER_BOUNCY = 0x1, // beings bounce off of it
+    COLLIDER_HIT_BACK = 0x2, // hurts what lands on it instead of being hurt
+    COLLIDER_GOAL = 0x4, // finishes the level
+};
+
+/**
+ enum for direction being is facing
+ */
+enum class Facing {
+    RIGHT,
+    LEFT,
+};
+
+/**
+ Where an entity is and how it reacts to being run into.
+ The box is in world pixels. Nothing in the game rotates or scales,
+ so the box is the entity's whole transform.
+ */
+struct Collider {
+    SDL_Rect box;
+    Uint8 flags; // ColliderFlags
+};
+
+/**
+ Velocity of an entity that moves, in px per ms
+ */
+struct Kinematics {
+    float x_vel;
+    float y_vel;
+    bool frozen; // waiting for the ground around it to load, skipped by every system
+};
+
+/**
+ Where a being is trying to go and its progress through a jump.
+ How fast it walks and how high it jumps come from its type.
+ */
+struct Locomotion {
+    float target_x_vel;
+    int air_jumps;
+    Uint32 jump_start_ts; // 0 means not jumping
+    Uint32 last_grounded; // ts of the last time we landed on something
+};
+
+/**
+ Hit points of something that can be hurt
+ */
+struct Health {
+    int hp;
+    Uint32 destroy_at_ts; // set when it dies, it is removed at this time
+};
+
+/**
+ Damage done to what runs into the entity
+ */
+struct Damage {
+    int amount;
+};
+
+/**
+ Automated behavior of an enemy, what it does is set by its type
+ */
+struct Ai {
+    Uint32 action_start_ts;
+    XorShift rng; // its own sequence, so its choices don't depend on what else is updated
+};
+
+/**
+ The animation a being is in, the sprite sheet and padding come from its type
+ */
+struct SpriteView {
+    Sprite sprite;
+    Facing facing;
+};
+
+/**
+ A fire tile that gives off embers
+ */
+struct EmberEmitter {
+    int ember_timer;
+};
+
+/**
+ Kinds of things that happen when entities run into each other
+ */
+enum class CollisionEventType : Uint8 {
+    HOP, // entity came down on top of other
+    BUMP, // entity and other ran into each other side to side
+    LAND, // entity touched down after being in the air
+    GOAL, // entity touched a goal
+};
+
+/**
+ Something that happened while moving, handled once everything has moved
+ */
+struct CollisionEvent {
+    CollisionEventType type;
+    EntityId entity;
+    EntityId other; // NO_ENTITY for events about one entity
+};
+
+/**
+ Dense storage for one type of component.
+ Components are packed in one array so systems loop over them in order,
+ with a sparse table by entity index to find the component of an entity.
+ Removing a component moves the last one into its place.
+ A stale handle has a different generation than the owner of the slot, so it finds nothing.
+ */
+template <typename T>
+class ComponentArray {
+private:
+    static constexpr Uint32 NO_SLOT = UINT32_MAX;
+    std::vector<T> components;
+    std::vector<EntityId> owners; // entity of each component
+    std::vector<Uint32> slots; // index into components by entity index, NO_SLOT if it has none
+public:
+    /** Give entity a component, replacing the one it has */
+    T& add(EntityId entity, const T &component) {
+        Uint32 index = entityIndex(entity);
+        if (index >= slots.size()) {
+            slots.resize(index + 1, NO_SLOT);
+        }
+        if (slots[index] != NO_SLOT) {
+            owners[slots[index]] = entity;
+            return components[slots[index]] = component;
+        }
+        slots[index] = Uint32(components.size());
+        components.push_back(component);
+        owners.push_back(entity);
+        return components.back();
+    }
+    /** Take the component away from entity, if it has one */
+    void remove(EntityId entity) {
+        if (!has(entity)) {
+            return;
+        }
+        Uint32 slot = slots[entityIndex(entity)];
+        Uint32 last = Uint32(components.size() - 1);
+        if (slot != last) {
+            components[slot] = components[last];
+            owners[slot] = owners[last];
+            slots[entityIndex(owners[slot])] = slot;
+        }
+        components.pop_back();
+        owners.pop_back();
+        slots[entityIndex(entity)] = NO_SLOT;
+    }
+    /** True if entity has this component */
+    bool has(EntityId entity) const {
+        Uint32 index = entityIndex(entity);
+        return index < slots.size() && slots[index] != NO_SLOT && owners[slots[index]] == entity;
+    }
+    /** Get the component of entity, NULL if it has none */
+    T* find(EntityId entity) { return has(entity) ? &components[slots[entityIndex(entity)]] : NULL; }
+    /** Get the component of entity, which must have one */
+    T& get(EntityId entity) { return components[slots[entityIndex(entity)]]; }
+    /** Number of entities with this component */
+    int size() const { return int(components.size()); }
+    /** Get the component at idx in the packed array */
+    T& at(int idx) { return components[idx]; }
+    /** Get the entity of the component at idx in the packed array */
+    EntityId ownerAt(int idx) const { return owners[idx]; }
+    /** Make room for count components and entity ids up to count without reallocating */
+    void reserve(size_t count) {
+        components.reserve(count);
+        owners.reserve(count);
+        slots.reserve(count);
+    }
+    /** Remove every component, keeping the memory to fill again */
+    void clear() {
+        components.clear();
+        owners.clear();
+        slots.clear();
+    }
+};
+
+/**
+ Where an entity id is in its lifetime
+ */
+enum EntityState : Uint8 {
+    ENTITY_FREE = 0, // not in use, can be handed out again
+    ENTITY_ALIVE = 1,
+    ENTITY_DESTROYED = 2, // will be removed at the end of the tick
+};
+
+/**
+ Every entity in the running level.
+ Tiles and beings are entities made of different components.
+ Systems read and write the component arrays directly.
+ Systems only destroy entities, they are removed together at the end of the tick
+ so the arrays being looped over don't change under them.
+ */
+class World {
+private:
+    std::vector<Uint8> entity_states; // EntityState by entity index
+    std::vector<Uint16> generations; // current generation of each entity index
+    std::vector<Uint32> free_indices;
+    std::vector<EntityId> pending_removal; // destroyed and waiting for removeDestroyed()
+    int entity_count = 0;
+    Uint32 seed = 0; // of the level, beings are seeded from it and where they were placed
+    std::function<void(EntityId)> goal_callback;
+
+    EntityId create();
+public:
+    ComponentArray<Collider> colliders;
+    ComponentArray<Kinematics> kinematics;
+    ComponentArray<Locomotion> locomotion;
+    ComponentArray<Health> health;
+    ComponentArray<Damage> damage;
+    ComponentArray<Ai> ai;
+    ComponentArray<SpriteView> sprites;
+    ComponentArray<EmberEmitter> emitters;
+    ComponentArray<const BeingType*> types; // of each being, shared with the other beings of the type
+    /** collisions from this tick's movement, in the order they happened */
+    std::vector<CollisionEvent> collisions;
+
+    EntityId createTile(int tile_num, int x_pos, int y_pos);
+    EntityId createBeing(const BeingType &type, int x_pos, int y_pos);
+    void remove(EntityId entity);
+    void destroy(EntityId entity);
+    bool isValid(EntityId entity);
+    bool isDestroyed(EntityId entity);
+    /** Get the entities destroyed since the last removeDestroyed(), in the order they were destroyed */
+    const std::vector<EntityId>& destroyedEntities() { return pending_removal; }
+    void removeDestroyed(EntityId keep = NO_ENTITY);
+    void reserve(size_t entities);
+    void clear();
+    /** Get the number of entities */
+    int count() { return entity_count; }
+    /** Set the seed that beings created from now on get their random numbers from */
+    void setSeed(Uint32 level_seed) { seed = level_seed; }
+    /** Set the callback that gets called with what hits a goal */
+    void setGoalCallback(std::function<void(EntityId)> callback) { goal_callback = callback; }
+    void hitGoal(EntityId entity);
+};
+
+#endif /* world_h */
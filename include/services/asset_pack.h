@@ -0,0 +1,75 @@
+//
+//  asset_pack.h
+//  Reads game assets out of one memory mapped pack file
+//
+//  Copyright © 2018 Vande Griek, Eric. All rights reserved.
+//
+
+#ifndef asset_pack_h
+#define asset_pack_h
+
+#include <string>
+#include "SDL.h"
+
+constexpr char ASSET_PACK_MAGIC[4] = {'H', 'O', 'P', 'A'};
+constexpr Uint16 ASSET_PACK_VERSION = 1;
+
+/**
+ Header at the start of an asset pack, written by asset_packer.py.
+ All fields are little endian.
+ */
+struct AssetPackHeader {
+    char magic[4];
+    Uint16 version;
+    Uint16 flags; // reserved
+    Uint32 entry_count;
+    Uint32 index_offset; // AssetPackEntry records sorted by hash
+    Uint32 names_offset; // asset names, not null terminated
+    Uint32 names_size;
+};
+static_assert(sizeof(AssetPackHeader) == 24, "AssetPackHeader must match the file layout");
+
+/**
+ One asset in the pack index.
+ The name is the path of the asset relative to the Assets directory.
+ */
+struct AssetPackEntry {
+    Uint64 hash; // FNV-1a of the name
+    Uint32 name_offset; // from names_offset
+    Uint32 name_len;
+    Uint32 data_offset; // from the start of the file
+    Uint32 data_size;
+};
+static_assert(sizeof(AssetPackEntry) == 24, "AssetPackEntry must match the file layout");
+
+/**
+ A memory mapped asset pack.
+ Assets are read in place through SDL_RWops, nothing is copied.
+ Read only once opened, so it can be used from any thread.
+ */
+class AssetPack {
+private:
+    const Uint8 *data = NULL;
+    size_t len = 0;
+    int entry_count = 0;
+
+    AssetPackEntry getEntry(int idx) const;
+public:
+    AssetPack() {}
+    ~AssetPack();
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    bool open(const std::string &filename);
+    void close();
+    /** True if a pack is open */
+    bool isOpen() const { return data != NULL; }
+    /** Get the number of assets in the pack */
+    int getEntryCount() const { return entry_count; }
+    bool find(const std::string &name, const Uint8 *&asset_data, size_t &asset_size) const;
+    SDL_RWops* openAsset(const std::string &name) const;
+};
+
+Uint64 hashAssetName(const std::string &name);
+
+#endif /* asset_pack_h */
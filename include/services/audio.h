@@ -10,29 +10,180 @@
 #define audio_h
 
 #include <string>
-#include <map>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include "SDL.h"
 #include "SDL_mixer.h"
 #include "resource_manager.h"
+#include "spsc_queue.h"
+#include "graphics.h"
+#include "soft_mixer.h"
+
+constexpr int AUDIO_FREQUENCY = 44100;
+constexpr int AUDIO_BUFFER_SAMPLES = 2048; // default device buffer, about 46 ms
+constexpr int AUDIO_LOW_LATENCY_SAMPLES = 512; // about 12 ms
+constexpr int AUDIO_MIN_BUFFER_SAMPLES = 256;
+constexpr float AUDIO_UNDERRUN_FACTOR = 1.5f; // a buffer this much later than expected means the device ran dry
+constexpr int AUDIO_UNDERRUN_LIMIT = 3; // this many underruns in one window doubles the buffer, up to the default
+constexpr Uint32 AUDIO_UNDERRUN_WINDOW_MS = 5000;
+constexpr int AUDIO_WARMUP_BUFFERS = 8; // timing of the first buffers after opening the device is ignored
+
+constexpr size_t SOUND_QUEUE_SIZE = 256; // sounds waiting for the audio thread, power of two
+constexpr int SOUND_CHANNELS = 16; // sounds that can play at once
+constexpr int MAX_SOUND_INSTANCES = 3; // copies of one sound that can play at once
+constexpr Uint32 SOUND_MERGE_WINDOW_MS = 16; // a sound started again this soon is merged into the first
+
+// positional sounds, distances are in world pixels from the center of the view
+constexpr float SOUND_FULL_VOLUME_RADIUS = 250; // full volume this close
+constexpr float SOUND_AUDIBLE_RADIUS = 1200; // fades out to nothing at this distance, further sounds aren't played
+constexpr float SOUND_MAX_PAN = 0.8f; // never play a sound entirely out of one speaker
+
+/**
+ How important a sound is.
+ When every channel is busy, a sound stops the oldest one playing with a lower priority.
+ */
+enum class SoundPriority : Uint8 {
+    AMBIENT,
+    NORMAL,
+    CRITICAL,
+};
+
+/**
+ A request to play a sound, passed from the game to the audio thread.
+ The sound is resolved to its chunk before it is queued.
+ */
+struct SoundEvent {
+    SoundId sound;
+    SoundPriority priority;
+    Uint8 left; // volume of each speaker, 255 is full
+    Uint8 right;
+    Mix_Chunk *chunk;
+};
+
+/**
+ The sound playing on a mixer channel, or as a voice of the software mixer.
+ Only used by the audio thread.
+ */
+struct Voice {
+    SoundId sound = NO_SOUND; // NO_SOUND when the channel is free
+    SoundPriority priority;
+    Uint32 start_ts;
+    // software mixer voices only, they have no callback when they finish
+    Uint32 end_ts;
+    Uint32 id;
+};
+
+/**
+ How the audio device is set up
+ */
+struct AudioConfig {
+    bool soft_mixer = false; // mix sound effects with SoftMixer
+    int buffer_samples = AUDIO_BUFFER_SAMPLES; // smaller plays sounds sooner but can underrun
+};
+
+/**
+ Measured timing of the audio device
+ */
+struct AudioLatencyStats {
+    int buffer_samples;
+    double buffer_ms; // time it takes to play one buffer, the latency the buffer adds
+    double avg_interval_ms; // between buffers being mixed
+    double max_interval_ms;
+    Uint32 buffers;
+    Uint32 underruns;
+    Uint32 reopens; // times the buffer was made bigger because of underruns
+};
 
 /**
- Singleton class for playing music and sound effects
+ What happened to the sounds the game asked for
+ */
+struct VoiceStats {
+    Uint32 played;
+    Uint32 merged; // started again within SOUND_MERGE_WINDOW_MS
+    Uint32 limited; // already MAX_SOUND_INSTANCES copies playing
+    Uint32 preempted; // stopped to make room for a more important sound
+    Uint32 dropped; // no channel free, or the queue was full
+    Uint32 culled; // too far away to hear
+};
+
+/**
+ Singleton class for playing music and sound effects.
+ Sound effects are queued without locking and played by an audio thread,
+ so talking to the mixer doesn't take time out of the game's frame.
  */
 class Audio {
 private:
     Audio();
     ~Audio();
     Mix_Music *bg_track;
-    std::map<std::string, Uint32> last_played_map;
+    std::vector<Uint32> last_played; // by SoundId
+
+    // shared with the audio thread
+    SpscQueue<SoundEvent, SOUND_QUEUE_SIZE> sound_queue;
+    std::thread audio_thread;
+    SDL_sem *queue_sem; // posted once for each event queued
+    std::atomic<bool> stopping;
+    std::atomic<Uint32> sounds_handled;
+    std::mutex flush_mutex;
+    std::condition_variable flush_cond; // notified when the audio thread has handled the queued sounds
+    std::atomic<bool> channel_done[SOUND_CHANNELS]; // set by the mixer when a channel finishes
+    std::atomic<Uint32> sounds_played;
+    std::atomic<Uint32> sounds_merged;
+    std::atomic<Uint32> sounds_limited;
+    std::atomic<Uint32> sounds_preempted;
+    std::atomic<Uint32> voices_dropped;
+    SoftMixer soft_mixer; // plays sound effects instead of the mixer channels when enabled
+    std::mutex forget_mutex;
+    std::vector<SoundId> forgotten; // sounds unloaded since the audio thread last looked
+    std::mutex device_mutex; // held by the audio thread while it uses the mixer, so the device can be reopened
+    int buffer_samples;
+    int frequency;
+    // set on the device thread
+    std::atomic<Uint64> last_buffer_ts;
+    std::atomic<Uint64> interval_ticks;
+    std::atomic<Uint64> max_interval_ticks;
+    std::atomic<Uint32> buffers_timed;
+    std::atomic<Uint32> underruns;
+    // only touched by the audio thread
+    Voice voices[SOUND_CHANNELS];
+    Voice soft_voices[SOFT_MIXER_VOICES];
+    Uint32 next_soft_voice_id;
+    std::vector<Uint32> last_started; // by SoundId
+    // only touched by the game thread
+    Uint32 sounds_queued;
+    Uint32 sounds_dropped; // queue was full
+    Uint32 sounds_culled;
+    Uint32 reopens;
+    Uint32 underrun_check_ts;
+    Uint32 underruns_at_check;
 
-    void setPlayed(const std::string &track_name);
+    void openDevice(int samples);
+    void reopenDevice(int samples);
+    static void timeBuffer(int, void*, int, void *udata);
+    void audioLoop();
+    void queueSound(SoundId sound, SoundPriority priority, Uint8 left, Uint8 right);
+    void setPlayed(SoundId sound);
+    void startVoice(const SoundEvent &event);
+    bool startSoftVoice(const SoundEvent &event, Voice &voice, Uint32 now);
+    int findVoice(const Voice *pool, int count, const SoundEvent &event);
+    void forgetSound(SoundId sound);
+    static void channelFinished(int channel);
 public:
     static Audio& instance();
-    void init();
+    void init(const AudioConfig &config = AudioConfig());
     void shutdown();
+    void update();
+    void flush();
     void setBgTrack(const std::string &track_name);
-    void playSound(const std::string &sound_name);
-    Uint32 getLastPlayed(const std::string &sound_name);
+    void playSound(const std::string &sound_name, SoundPriority priority = SoundPriority::NORMAL);
+    void playSound(SoundId sound, SoundPriority priority = SoundPriority::NORMAL);
+    void playSoundAt(SoundId sound, int xpos, int ypos, SoundPriority priority = SoundPriority::NORMAL);
+    Uint32 getLastPlayed(SoundId sound);
+    VoiceStats getVoiceStats();
+    AudioLatencyStats getLatencyStats();
 };
 
 #endif /* audio_h */
@@ -0,0 +1,38 @@
+//
+//  file_watcher.h
+//  Singleton that reports asset files that changed on disk
+//
+//  Copyright © 2018 Vande Griek, Eric. All rights reserved.
+//
+
+#ifndef file_watcher_h
+#define file_watcher_h
+
+#include <string>
+#include <vector>
+#include <map>
+#include "SDL.h"
+
+constexpr int FILE_WATCHER_BUFFER_SIZE = 4096;
+
+/**
+ Singleton that watches directories for files being written.
+ Uses inotify, so it only works on Linux. Elsewhere nothing is ever reported.
+ */
+class FileWatcher {
+private:
+    FileWatcher();
+    ~FileWatcher();
+    int notify_fd;
+    /** watched directory for each watch descriptor, ending in a slash */
+    std::map<int, std::string> watch_dirs;
+    std::vector<std::string> changed;
+public:
+    static FileWatcher& instance();
+    void init();
+    void shutdown();
+    bool watch(const std::string &dir, bool recursive);
+    const std::vector<std::string>& poll();
+};
+
+#endif /* file_watcher_h */
@@ -23,12 +23,17 @@ private:
     ~Graphics();
     SDL_Window *window;
     SDL_Renderer *renderer;
+    /** low resolution target the world is drawn into, NULL when drawing directly */
+    SDL_Texture *world_target;
+    int world_divisor;
+    bool fullscreen;
+    bool gl_swap;
     int window_width;
     int window_height;
     int screen_off_x;
     int screen_off_y;
 public:
-    void init(int window_width, int window_height);
+    void init(int window_width, int window_height, int world_divisor);
     void shutdown();
     static Graphics& instance();
     
@@ -38,19 +43,28 @@ public:
     /** return the SDL_Renderer object */
     SDL_Renderer* getRenderer() { return renderer; }
     
-    /** return the width of the SDL window */
+    /** return the logical width of the game view, independent of the real window size */
     int getWindowWidth() { return window_width; }
     
-    /** return the width of the SDL window */
+    /** return the logical height of the game view, independent of the real window size */
     int getWindowHeight() { return window_height; }
     
+    /** return how many times smaller the world is drawn than the view */
+    int getWorldDivisor() { return world_divisor; }
+    
     void clear();
     void clearColor(int red, int green, int blue);
+    void beginWorld();
+    void endWorld();
     void swapFrame();
+    void toggleFullscreen();
     void updateWindowTitle(std::string window_title);
     
     /** return the current world offset that the screen is showing */
     std::tuple<int, int> getScreenOffsets() { return std::make_tuple(screen_off_x, screen_off_y); }
+    
+    /** return the area of the world the screen is showing */
+    SDL_Rect getViewRect() { return {screen_off_x, screen_off_y, window_width, window_height}; }
     void focusScreenOffsets(const SDL_Rect &rect);
 };
 
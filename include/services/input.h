@@ -22,6 +22,9 @@
 constexpr SDL_Scancode KEY_QUIT = SDL_SCANCODE_Q;
 constexpr SDL_Scancode KEY_FPS_TOGGLE = SDL_SCANCODE_F;
 constexpr SDL_Scancode KEY_PAUSE = SDL_SCANCODE_ESCAPE;
+constexpr SDL_Scancode KEY_FULLSCREEN = SDL_SCANCODE_F11;
+constexpr SDL_Scancode KEY_MEMORY_REPORT = SDL_SCANCODE_M;
+constexpr SDL_Scancode KEY_TIMING_REPORT = SDL_SCANCODE_T;
 constexpr SDL_Scancode KEY_RIGHT_1 = SDL_SCANCODE_D;
 constexpr SDL_Scancode KEY_RIGHT_2 = SDL_SCANCODE_RIGHT;
 constexpr SDL_Scancode KEY_LEFT_1 = SDL_SCANCODE_A;
@@ -36,6 +39,9 @@ enum class Action {
     ADVACNE,
     TOGGLE_FPS,
     TOGGLE_PAUSE,
+    TOGGLE_FULLSCREEN,
+    MEMORY_REPORT,
+    TIMING_REPORT,
     
     MOVE_LEFT,
     STOP_LEFT,
@@ -0,0 +1,93 @@
+//
+//  particles.h
+//  Singleton that simulates and draws pooled particle effects
+//
+//  Copyright © 2018 Vande Griek, Eric. All rights reserved.
+//
+
+#ifndef particles_h
+#define particles_h
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "SDL.h"
+#include "graphics.h"
+#include "xorshift.h"
+
+constexpr int MAX_PARTICLES_PER_EFFECT = 8192;
+constexpr int PARTICLE_FADE_STEPS = 4; // particles fade out in this many alpha steps
+
+/**
+ The kinds of particle effects.
+ Each one has its own pool so it can be drawn in one batch.
+ */
+enum class ParticleEffect {
+    LANDING_DUST,
+    DEATH_BURST,
+    DAMAGE_SPARKS,
+    EMBERS,
+};
+constexpr int PARTICLE_EFFECT_COUNT = 4;
+
+/**
+ How the particles of one effect look and move
+ */
+struct ParticleConfig {
+    Uint8 red;
+    Uint8 green;
+    Uint8 blue;
+    int size; // side of the square in world pixels
+    float min_life; // ms
+    float max_life;
+    float min_speed; // px per ms
+    float max_speed;
+    float min_angle; // radians, 0 is right and positive is down
+    float max_angle;
+    float gravity; // px per ms^2
+};
+
+/**
+ Fixed capacity structure-of-arrays storage for one effect.
+ Live particles are kept packed at the front so loops run over contiguous floats.
+ */
+struct ParticlePool {
+    int count = 0;
+    float x[MAX_PARTICLES_PER_EFFECT];
+    float y[MAX_PARTICLES_PER_EFFECT];
+    float x_vel[MAX_PARTICLES_PER_EFFECT];
+    float y_vel[MAX_PARTICLES_PER_EFFECT];
+    float life[MAX_PARTICLES_PER_EFFECT]; // ms left to live
+    float max_life[MAX_PARTICLES_PER_EFFECT];
+};
+
+/**
+ Singleton that owns every particle in the game.
+ Nothing is allocated per particle, emitting into a full pool drops the new particles.
+ */
+class Particles {
+private:
+    Particles();
+    ~Particles();
+    ParticlePool pools[PARTICLE_EFFECT_COUNT];
+    /** scratch space for building the rects of each fade step, reserved in init */
+    std::vector<SDL_Rect> batches[PARTICLE_FADE_STEPS];
+    /** separate from the game's generator so that effects don't change what enemies do */
+    XorShift rng;
+
+    float randomRange(float low, float high);
+    void updatePool(ParticlePool &pool, float gravity, float delta);
+    void renderPool(ParticlePool &pool, const ParticleConfig &config);
+public:
+    static Particles& instance();
+    void init();
+    void shutdown();
+    void clear();
+    void emit(ParticleEffect effect, float xpos, float ypos, int count, float spread_x = 0);
+    void update(int delta);
+    void render();
+    /** Get the number of live particles across all effects */
+    int liveCount();
+};
+
+#endif /* particles_h */
@@ -11,21 +11,108 @@
 
 #include <string>
 #include <map>
+#include <set>
+#include <deque>
+#include <vector>
+#include <algorithm>
 #include <utility>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
 #include "SDL.h"
 #include "SDL_image.h"
 #include "SDL_mixer.h"
 #include "SDL_ttf.h"
 #include "graphics.h"
+#include "asset_pack.h"
 
+constexpr auto ASSET_DIR = "./Assets/";
+constexpr auto ASSET_PACK_FILE = "./assets.pack";
 constexpr auto IMAGE_DIR = "./Assets/images/";
 constexpr auto MUSIC_DIR = "./Assets/music/";
 constexpr auto SOUNDS_DIR = "./Assets/sounds/";
 constexpr auto FONT_FILE = "./Assets/fonts/space-mono/SpaceMono-Bold.ttf";
 
+/**
+ Dense handles for assets, resolved from their names once at load time
+ so that looking them up each frame is an array index.
+ */
+typedef int ImageId;
+typedef int SoundId;
+constexpr ImageId NO_IMAGE = -1;
+constexpr SoundId NO_SOUND = -1;
+
+constexpr int ASSET_WORKER_COUNT = 2; // threads decoding assets in the background
+constexpr int MAX_ASSET_UPLOADS_PER_UPDATE = 4; // limit the work update() does in one frame
+constexpr SDL_Color PLACEHOLDER_COLOR = {255, 0, 255, 160}; // drawn in place of images that aren't loaded
+
+/**
+ Where an asset requested in the background is at
+ */
+enum class AssetState {
+    NONE,
+    PENDING,
+    READY,
+    FAILED,
+};
+
+/**
+ Tracks one asset requested in the background.
+ Only changed on the main thread. Goes back to NONE when the asset is unloaded.
+ */
+struct AssetSlot {
+    AssetState state = AssetState::NONE;
+    void *asset = NULL;
+};
+
+/**
+ Future-like handle to an asset being loaded in the background.
+ get() returns the placeholder until the asset is ready.
+ */
+template <typename T>
+class AssetHandle {
+private:
+    const AssetSlot *slot = NULL;
+    T *placeholder = NULL;
+public:
+    AssetHandle() {}
+    AssetHandle(const AssetSlot *slot, T *placeholder) : slot(slot), placeholder(placeholder) {}
+    /** True once the asset can be used */
+    bool isReady() const { return slot != NULL && slot->state == AssetState::READY; }
+    /** True if the asset couldn't be loaded */
+    bool isFailed() const { return slot != NULL && slot->state == AssetState::FAILED; }
+    /** Get the asset, or the placeholder if it isn't ready */
+    T* get() const { return isReady() ? static_cast<T*>(slot->asset) : placeholder; }
+};
+
+/**
+ Kinds of assets that can be decoded in the background
+ */
+enum class AssetKind {
+    IMAGE,
+    SOUND,
+};
+
+/**
+ An asset to decode on a worker thread.
+ data is the decoded SDL_Surface or Mix_Chunk, NULL if it failed.
+ SDL errors are kept per thread, so the worker copies the reason it failed into error.
+ */
+struct AssetJob {
+    AssetKind kind;
+    std::string name;
+    void *data;
+    std::string error;
+};
+
 /**
  Singleton that manages images, rendered text, sound effects and music data.
- Remembers what has been loaded already so that it can be re-used
+ Remembers what has been loaded already so that it can be re-used.
+ Assets are read from the asset pack when there is one, otherwise from their own files.
+ Images and sounds loaded by name stay loaded until shutdown. Ones used through handles
+ are reference counted and freed once nothing holds them, such as when the level they
+ were used by ends.
  */
 class ResourceManager {
 private:
@@ -36,8 +123,54 @@ private:
     std::map<std::pair<std::string, int>, SDL_Texture*> text_map;
     std::map<std::string, Mix_Music*> music_map;
     std::map<std::string, Mix_Chunk*> sound_map;
+    SDL_Texture *placeholder;
+    AssetPack pack;
+
+    // assets by handle, filled in the first time each one is used
+    std::map<std::string, ImageId> image_ids;
+    std::vector<std::string> image_names;
+    std::vector<SDL_Texture*> image_table;
+    std::map<std::string, SoundId> sound_ids;
+    std::vector<std::string> sound_names;
+    std::vector<Mix_Chunk*> sound_table;
+    // reference counts by handle, pinned assets were loaded by name and are never freed
+    std::vector<int> image_refs;
+    std::vector<Uint8> image_pinned;
+    std::vector<int> sound_refs;
+    std::vector<Uint8> sound_pinned;
+    // told when a sound is freed
+    std::function<void(SoundId)> sound_unload_callback;
+    // held for the current level
+    std::vector<ImageId> level_images;
+    std::vector<SoundId> level_sounds;
+
+    // time spent loading assets, to compare loading from the pack and from files
+    int assets_loaded;
+    Uint64 load_ticks;
+
+    // assets requested in the background, map nodes don't move so handles can point at them
+    // slots are never erased before shutdown, unloading an asset resets its slot
+    std::map<std::string, AssetSlot> image_slots;
+    std::map<std::string, AssetSlot> sound_slots;
+    // shared with the worker threads
+    std::vector<std::thread> workers;
+    std::mutex job_mutex;
+    std::condition_variable job_cond;
+    std::deque<AssetJob> jobs;
+    std::deque<AssetJob> finished_jobs;
+    bool stopping;
+
+    void workerLoop();
+    void queueJob(AssetKind kind, const std::string &name);
+    void finishJob(AssetJob &job);
     
+    SDL_Texture* loadImage(const std::string &name);
+    Mix_Chunk* loadSound(const std::string &name);
+    void unloadImage(ImageId id);
+    void unloadSound(SoundId id);
     TTF_Font* getFont(int font_size);
+    SDL_RWops* openAsset(const std::string &path);
+    void countLoad(Uint64 start);
     
     void free_images();
     void free_text();
@@ -49,9 +182,41 @@ public:
     void init();
     void shutdown();
     SDL_Texture* getImageTexture(const std::string &filename);
+    ImageId getImageId(const std::string &name);
+    /** Get the name an ImageId was made from */
+    const std::string& getImageName(ImageId id) { return image_names[id]; }
+    SDL_Texture* getImage(ImageId id);
+    /** Get the texture for an image handle if it is loaded, NULL while it is loading. Never loads it. */
+    SDL_Texture* getLoadedImage(ImageId id) { return image_table[id]; }
+    SDL_Texture* getPlaceholderImage();
+    std::set<std::string> getLoadedImageNames();
+    SDL_Surface* decodeImage(const std::string &name);
+    SDL_Texture* addImage(const std::string &name, SDL_Surface *surf);
+    bool reloadImage(const std::string &name);
     SDL_Texture* getTextTexture(const std::string &text, int font_size);
     Mix_Music* getMusic(const std::string &track_name);
     Mix_Chunk* getSound(const std::string &sound_name);
+    SoundId getSoundId(const std::string &name);
+    Mix_Chunk* getSound(SoundId id);
+    /** Get the number of sounds that have been given a SoundId */
+    int getSoundCount() { return int(sound_names.size()); }
+    /** Get the name a SoundId was made from */
+    const std::string& getSoundName(SoundId id) { return sound_names[id]; }
+    void retainImage(ImageId id);
+    void releaseImage(ImageId id);
+    /** Set a function to call with each sound that is unloaded, such as to drop copies of it */
+    void setSoundUnloadCallback(std::function<void(SoundId)> callback) { sound_unload_callback = callback; }
+    void retainSound(SoundId id);
+    void releaseSound(SoundId id);
+    void setLevelAssets(const std::vector<ImageId> &images, const std::vector<SoundId> &sounds);
+    void freeUnused();
+    void logMemoryReport();
+    Mix_Chunk* decodeSound(const std::string &name);
+    AssetHandle<SDL_Texture> loadImageAsync(const std::string &name, SDL_Texture *placeholder);
+    AssetHandle<Mix_Chunk> loadSoundAsync(const std::string &name);
+    void update();
+    void logLoadStats();
+    std::string readText(const std::string &path);
 };
 
 #endif /* resource_manager_h */
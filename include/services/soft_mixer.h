@@ -0,0 +1,100 @@
+//
+//  soft_mixer.h
+//  Mixes sound effects in software on top of SDL_mixer's output
+//
+//  Copyright © 2018 Vande Griek, Eric. All rights reserved.
+//
+
+#ifndef soft_mixer_h
+#define soft_mixer_h
+
+#include <vector>
+#include <utility>
+#include <atomic>
+#include "SDL.h"
+#include "SDL_mixer.h"
+#include "resource_manager.h"
+#include "spsc_queue.h"
+
+constexpr int SOFT_MIXER_VOICES = 512; // sounds that can play at once
+constexpr size_t SOFT_MIXER_QUEUE_SIZE = 256; // voices waiting to be started, power of two
+constexpr int SOFT_MIXER_BUFFER_FLOATS = 8192; // mixing space allocated up front, more if the device buffer is bigger
+constexpr int SOFT_MIXER_BENCH_FRAMES = 512; // frames in each buffer the benchmark mixes
+
+/**
+ A sound playing in the software mixer.
+ Samples are interleaved stereo floats at the device rate, in the range of Sint16.
+ */
+struct SoftVoice {
+    const float *samples;
+    Uint32 length; // in floats
+    Uint32 pos;
+    float left;
+    float right;
+    Uint32 id; // given by whoever started it, to stop it with
+};
+
+/**
+ How long mixing has taken
+ */
+struct SoftMixerStats {
+    Uint32 buffers; // audio buffers mixed
+    Uint32 peak_voices; // most voices mixed into one buffer
+    Uint32 dropped; // voices that didn't fit
+    double avg_ms; // per buffer
+    double max_ms;
+};
+
+/**
+ Mixes sound effects itself instead of giving each one a mixer channel.
+ Hooked in as SDL_mixer's post mix effect, so music still plays through SDL_mixer.
+ Sounds are converted to floats once and any number of voices up to SOFT_MIXER_VOICES
+ are summed with SIMD when the CPU has it.
+ Voices are started from the audio thread and mixed on SDL's audio device thread.
+ */
+class SoftMixer {
+private:
+    bool enabled = false;
+
+    // only touched by the audio thread
+    std::vector<std::vector<float>> samples; // by SoundId, never changed once converted until forgotten
+    // converted sounds that were forgotten, freed once the time they could still be playing until has passed
+    std::vector<std::pair<Uint32, std::vector<float>>> retired;
+    int frequency = 0;
+    int buffer_samples = 0;
+
+    // passes voices from the audio thread to the device thread
+    SpscQueue<SoftVoice, SOFT_MIXER_QUEUE_SIZE> starts;
+    SpscQueue<Uint32, SOFT_MIXER_QUEUE_SIZE> stops; // ids of voices to stop
+
+    // only touched by the device thread
+    SoftVoice voices[SOFT_MIXER_VOICES];
+    int voice_count = 0;
+    std::vector<float> mix_buffer;
+
+    std::atomic<Uint32> buffers_mixed;
+    std::atomic<Uint32> peak_voices;
+    std::atomic<Uint32> voices_dropped;
+    std::atomic<Uint64> mix_ticks;
+    std::atomic<Uint64> max_mix_ticks;
+
+    static void postMix(void *udata, Uint8 *stream, int len);
+    void mix(Sint16 *stream, int count);
+    void removeVoice(Uint32 id);
+public:
+    bool init(int buffer_samples);
+    void attach(int buffer_samples);
+    void shutdown();
+    /** True if sounds should be played through the software mixer */
+    bool isEnabled() { return enabled; }
+    bool play(SoundId sound, const Mix_Chunk *chunk, float left, float right, Uint32 id);
+    bool stop(Uint32 id);
+    void forget(SoundId sound);
+    SoftMixerStats getStats();
+};
+
+void mixVoices(float *out, int count, SoftVoice *voices, int &voice_count, bool use_simd);
+void addToStream(Sint16 *stream, const float *mix, int count, bool use_simd);
+void benchmarkSoftMixer(int voice_count, int buffers);
+
+#endif /* soft_mixer_h */
@@ -0,0 +1,54 @@
+//
+//  object_pool.h
+//  Hands out objects carved from contiguous blocks and takes them back for reuse
+//
+//  Copyright © 2018 Vande Griek, Eric. All rights reserved.
+//
+
+#ifndef object_pool_h
+#define object_pool_h
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+/**
+ Pool of objects of one type, allocated BlockSize at a time.
+ Released objects are kept as they are and handed out again,
+ so anything they own (such as the capacity of their vectors) is reused.
+ Nothing is freed until the pool is destroyed. Not thread safe.
+ */
+template <typename T, size_t BlockSize>
+class ObjectPool {
+private:
+    static_assert(BlockSize > 0, "ObjectPool blocks must hold at least one object");
+
+    std::vector<std::unique_ptr<T[]>> blocks;
+    std::vector<T*> available;
+public:
+    /**
+     Get an object that isn't in use, allocating a new block if there isn't one.
+     The object is in whatever state it was released in.
+     */
+    T* acquire() {
+        if (available.empty()) {
+            blocks.emplace_back(new T[BlockSize]);
+            T *block = blocks.back().get();
+            // hand out the start of the block first
+            for (size_t idx = BlockSize; idx > 0; --idx) {
+                available.push_back(block + idx - 1);
+            }
+        }
+        T *object = available.back();
+        available.pop_back();
+        return object;
+    }
+    /** Give an object back to the pool, it must have come from acquire() */
+    void release(T *object) { available.push_back(object); }
+    /** Number of objects allocated, in use or not */
+    size_t capacity() const { return blocks.size() * BlockSize; }
+    /** Number of objects handed out and not released */
+    size_t inUse() const { return capacity() - available.size(); }
+};
+
+#endif /* object_pool_h */
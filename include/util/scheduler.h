@@ -0,0 +1,58 @@
+//
+//  scheduler.h
+//  Runs subsystems at their own rates and times how long they take
+//
+//  Copyright © 2018 Vande Griek, Eric. All rights reserved.
+//
+
+#ifndef scheduler_h
+#define scheduler_h
+
+#include <vector>
+#include <string>
+#include <functional>
+#include "SDL.h"
+
+// tasks that don't run every frame start this far apart, so they don't all land on the same frame
+constexpr int SCHEDULER_STAGGER_MS = 16;
+
+/**
+ A subsystem run by the Scheduler, with counters of how long its runs took
+ */
+struct ScheduledTask {
+    std::string name;
+    /** least ms between runs, 0 runs every update */
+    int interval;
+    /** ms that have passed since the last run */
+    int pending;
+    /** runs that take longer than this many ms are counted as over budget */
+    float budget_ms;
+    /** called with the ms that have passed since its last run */
+    std::function<void(int)> run;
+
+    // counters since the stats were last reset
+    int runs;
+    int over_budget;
+    Uint64 total_ticks;
+    Uint64 max_ticks;
+};
+
+/**
+ Runs each registered task when its interval has passed, in the order they were added.
+ Slow tasks can run less often than every frame, and their cost is spread out over frames.
+ */
+class Scheduler {
+private:
+    std::vector<ScheduledTask> tasks;
+    /** updates since the stats were last reset */
+    int updates;
+public:
+    Scheduler() : updates(0) {}
+
+    void add(const std::string &name, int interval, float budget_ms, std::function<void(int)> run);
+    void update(int delta);
+    void logStats();
+    void resetStats();
+};
+
+#endif /* scheduler_h */
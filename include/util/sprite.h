@@ -56,11 +56,11 @@ private:
     int frame_count; // number of frames in the cycle
     unsigned int start_time;
     SDL_Rect frame_rect;
-    FrameConfig frame_config;
+    const FrameConfig *frame_config; // shared by every sprite of the same type
     
     void setFrame(int frame);
 public:
-    void init(FrameConfig frame_config);
+    void init(const FrameConfig &frame_config);
     /** Get the current source rect from the sprite sheet */
     SDL_Rect& getFrameRect() { return frame_rect; }
     void setState(SpriteState state);
@@ -0,0 +1,62 @@
+//
+//  spsc_queue.h
+//  Fixed size lock-free queue for one producer thread and one consumer thread
+//
+//  Copyright © 2018 Vande Griek, Eric. All rights reserved.
+//
+
+#ifndef spsc_queue_h
+#define spsc_queue_h
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ Ring buffer that one thread pushes onto and another thread pops from without locking.
+ Capacity must be a power of two. Pushing never blocks, it fails when the queue is full.
+ */
+template <typename T, size_t Capacity>
+class SpscQueue {
+private:
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+    T items[Capacity];
+    // each written by one side only, kept on separate cache lines so the threads don't contend
+    alignas(64) std::atomic<size_t> head{0}; // next item to pop
+    alignas(64) std::atomic<size_t> tail{0}; // next slot to push into
+public:
+    /**
+     Add an item to the back of the queue. Only call from the producer thread.
+     Returns false if the queue is full.
+     */
+    bool push(const T &item) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        if (pos - head.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        items[pos & (Capacity - 1)] = item;
+        tail.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     Take the item at the front of the queue. Only call from the consumer thread.
+     Returns false if the queue is empty.
+     */
+    bool pop(T &item) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        if (pos == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items[pos & (Capacity - 1)];
+        head.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** True if there is nothing to pop, may be out of date by the time it returns */
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+};
+
+#endif /* spsc_queue_h */
@@ -0,0 +1,52 @@
+//
+//  xorshift.h
+//  Small seeded random number generator
+//
+//  Copyright © 2018 Vande Griek, Eric. All rights reserved.
+//
+
+#ifndef xorshift_h
+#define xorshift_h
+
+#include "SDL.h"
+
+/**
+ xorshift random numbers.
+ Used instead of rand() and <random> distributions so the same seed gives the same numbers everywhere.
+ The whole state is four bytes, so anything that needs its own sequence can carry a generator.
+ */
+class XorShift {
+private:
+    Uint32 state;
+public:
+    /** Seed the generator, 0 is not a valid xorshift state */
+    XorShift(Uint32 seed) : state(seed != 0 ? seed : 0x9E3779B9) {}
+    /** Get the next random number */
+    Uint32 next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+    /** True with the given chance from 0 to 1 */
+    bool chance(float odds) { return (next() & 0xFFFFFF) < odds * 0x1000000; }
+    /** Get a random int from low to high inclusive */
+    int range(int low, int high) { return low + int(next() % Uint32(high - low + 1)); }
+};
+
+/**
+ Combine a seed and a value into a new seed, such as a level seed and where an entity was placed.
+ Values that are close together give unrelated seeds.
+ */
+inline Uint32 mixSeed(Uint32 seed, Uint32 value) {
+    // murmur3 finalizer
+    Uint32 hash = seed ^ (value + 0x9E3779B9 + (seed << 6) + (seed >> 2));
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6B;
+    hash ^= hash >> 13;
+    hash *= 0xC2B2AE35;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+#endif /* xorshift_h */
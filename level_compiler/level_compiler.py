@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+# compiles text level files into the binary format the game memory maps
+
+import sys
+import os
+import re
+import struct
+import argparse
+
+MAGIC = b'HOPL'
+VERSION = 1
+# magic, version, flags, width, height, entity_count, entity_offset
+HEADER_FORMAT = '<4sHHIIII'
+# tx, ty, type, padding
+ENTITY_FORMAT = '<IIB3x'
+BIN_SUFFIX = '.bin'
+LEVEL_NAME_PATTERN = re.compile(r'^level_\d+$')
+
+EMPTY_TILE_NUM = 0
+# player and enemies are stored outside of the tile grid
+ENTITY_TILE_NUMS = {5, 6, 7}
+MAX_TILE_NUM = 255
+
+
+def read_text_level(filename):
+    with open(filename, 'r') as lvl_file:
+        width, height = (int(tok) for tok in lvl_file.readline().split())
+        tiles = []
+        for line in lvl_file:
+            row = [int(tok) for tok in line.split()]
+            if not row:
+                continue
+            if len(row) != width:
+                raise ValueError('{0}: row {1} has {2} tiles, expected {3}'.format(
+                    filename, len(tiles) + 1, len(row), width))
+            tiles.append(row)
+    if len(tiles) != height:
+        raise ValueError('{0}: has {1} rows, expected {2}'.format(filename, len(tiles), height))
+    return width, height, tiles
+
+
+def compile_level(in_file, out_file, keep_entities):
+    width, height, tiles = read_text_level(in_file)
+
+    tile_bytes = bytearray()
+    entities = []
+    for ty, row in enumerate(tiles):
+        for tx, tile_num in enumerate(row):
+            if not 0 <= tile_num <= MAX_TILE_NUM:
+                raise ValueError('{0}: tile {1} at ({2},{3}) does not fit in a byte'.format(
+                    in_file, tile_num, tx, ty))
+            if not keep_entities and tile_num in ENTITY_TILE_NUMS:
+                entities.append((tx, ty, tile_num))
+                tile_num = EMPTY_TILE_NUM
+            tile_bytes.append(tile_num)
+
+    # align the entity records after the tiles
+    header_size = struct.calcsize(HEADER_FORMAT)
+    tiles_end = header_size + len(tile_bytes)
+    entity_offset = (tiles_end + 3) & ~3 if entities else 0
+    padding = bytes(entity_offset - tiles_end) if entities else b''
+
+    with open(out_file, 'wb') as bin_file:
+        bin_file.write(struct.pack(HEADER_FORMAT, MAGIC, VERSION, 0, width, height,
+                                   len(entities), entity_offset))
+        bin_file.write(tile_bytes)
+        bin_file.write(padding)
+        for entity in entities:
+            bin_file.write(struct.pack(ENTITY_FORMAT, *entity))
+    print('{0} -> {1} ({2}x{3}, {4} entities)'.format(in_file, out_file, width, height, len(entities)))
+
+
+def find_levels(directory):
+    return sorted(os.path.join(directory, name) for name in os.listdir(directory)
+                  if LEVEL_NAME_PATTERN.match(name))
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser()
+    parser.add_argument("levels", nargs='+',
+                        help="Text level files, or directories to compile every level_N file in")
+    parser.add_argument("--keep-entities", action='store_true',
+                        help="Leave the player and enemies in the tile grid")
+    args = parser.parse_args()
+
+    for path in args.levels:
+        in_files = find_levels(path) if os.path.isdir(path) else [path]
+        for in_file in in_files:
+            try:
+                compile_level(in_file, in_file + BIN_SUFFIX, args.keep_entities)
+            except (OSError, ValueError) as ex:
+                print('Failed to compile {0}: {1}'.format(in_file, ex))
+                sys.exit(1)
@@ -8,13 +8,13 @@ COMPILER="clang++"
 
 SOURCE="./src/*.cpp ./src/*/*.cpp"
 
-ARGUMENTS="-D LINUX -std=c++14" 
+ARGUMENTS="-D LINUX -std=c++17 -O2" 
 
 # Which directories do we want to include.
 INCLUDE_DIR="-I ./include/game -I ./include/services -I ./include/gui -I ./include/util -I/usr/include/SDL2 -D_REENTRANT"
 
 # What libraries do we want to include
-LIBRARIES="-L/usr/lib/x86_64-linux-gnu -lSDL2 -lSDL2_mixer -lSDL2_image -lSDL2_ttf"
+LIBRARIES="-L/usr/lib/x86_64-linux-gnu -lSDL2 -lSDL2_mixer -lSDL2_image -lSDL2_ttf -pthread"
 
 # The name of our executable
 EXECUTABLE="./Game/Hopman"
@@ -26,6 +26,12 @@ compileString=COMPILER+" "+ARGUMENTS+" -o "+EXECUTABLE+" "+" "+INCLUDE_DIR+" "+S
 os.system('mkdir -p ./Game')
 os.system('cp -r Assets ./Game/')
 
+# compile the text levels into the binary format the game loads
+os.system('python3 level_compiler/level_compiler.py ./Game/Assets/levels')
+
+# pack the other assets into one file the game memory maps
+os.system('python3 asset_packer/asset_packer.py ./Game/Assets ./Game/assets.pack')
+
 # Print out the compile string
 print("Building...")
 
@@ -8,7 +8,7 @@ COMPILER="clang++"
 
 SOURCE="./src/*.cpp ./src/*/*.cpp"
 
-ARGUMENTS="-D MAC -std=c++14" 
+ARGUMENTS="-D MAC -std=c++17 -O2" 
 
 # Which directories do we want to include.
 SDL_INCLUDE="-I ./lib/osx/SDL2.framework/Headers -I ./lib/osx/SDL2_image.framework/Headers -I ./lib/osx/SDL2_mixer.framework/Headers -I ./lib/osx/SDL2_ttf.framework/Headers"
@@ -27,6 +27,12 @@ compileString=" ".join([COMPILER, ARGUMENTS, "-o " + EXECUTABLE, SDL_INCLUDE, GA
 os.system('mkdir -p ./Game')
 os.system('cp -r Assets ./Game/')
 
+# compile the text levels into the binary format the game loads
+os.system('python3 level_compiler/level_compiler.py ./Game/Assets/levels')
+
+# pack the other assets into one file the game memory maps
+os.system('python3 asset_packer/asset_packer.py ./Game/Assets ./Game/assets.pack')
+
 # Print out the compile string
 print("Building...")
 
@@ -3,146 +3,273 @@
 //  Copyright © 2018 Vande Griek, Eric. All rights reserved.
 //
 
+#include <set>
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
 #include "being_type.h"
+#include "tile.h"
 
-// these should be read from a config file instead of statically defined
+// keys every type has to set, the rest default to 0, false, none or no sound
+static const char *REQUIRED_KEYS[] = {
+    "tile", "sprite_sheet", "idle_frames", "walking_frames", "jumping_frames", "braking_frames",
+    "dead_frames", "size", "hp", "top_speed", "jump_duration",
+};
 
 /**
- Get the BeingType for a player
+ Throw an error for line of a being types file
  */
-BeingType& BeingType::player() {
-    static BeingType this_type;
-    static bool init_done = false;
-    if (!init_done) {
-        init_done = true;
-
-        this_type.sprite_sheet = "sprites/player.png";
-        this_type.frame_config =
-        {
-            0, 3, // idle
-            5, 7, // walking
-            8, 8, // jump
-            9, 9, // braking
-            4, 4, // dead
-        };
-        this_type.pad_top = 4;
-        this_type.pad_right = 6;
-        this_type.pad_bot = 0;
-        this_type.pad_left = 6;
-
-        this_type.hp = 1;
-        this_type.damage = 1;
-        this_type.score_on_destruction = 0;
-        this_type.width = 32 - this_type.pad_left - this_type.pad_right;
-        this_type.height = 32 - this_type.pad_top - this_type.pad_bot;
-        this_type.top_speed = 300 / 1000.0f;
-        this_type.max_air_jumps = 1;
-        this_type.jump_duration = 275;
-
-        this_type.action_type = ActionType::NONE;
-        this_type.bump_immune = false;
-        this_type.bouncy = true;
-        this_type.hit_back_when_hopped_on = false;
-
-        this_type.walk_sound = "player_walk.wav";
-        this_type.jump_sound = "player_jump.wav";
-        this_type.landed_sound = "player_landed.wav";
-        this_type.damaged_sound = "player_damaged.wav";
-        this_type.death_sound = "player_death.wav";
+[[noreturn]] static void throwTypesError(const std::string &filename, int line, const std::string &msg) {
+    throw std::runtime_error("Failed to parse being types file " + filename + ":" + std::to_string(line)
+                             + ": " + msg);
+}
+
+/**
+ Get str without the spaces at either end
+ */
+static std::string trim(const std::string &str) {
+    size_t start = str.find_first_not_of(" \t\r");
+    if (start == std::string::npos) {
+        return "";
     }
-    return this_type;
+    size_t end = str.find_last_not_of(" \t\r");
+    return str.substr(start, end - start + 1);
 }
 
 /**
- Get the BeingType for a red enemey
+ Read count whitespace separated integers out of value.
+ Returns false unless value is exactly that many integers.
  */
-BeingType& BeingType::redEnemy() {
-    static BeingType this_type;
-    static bool init_done = false;
-    if (!init_done) {
-        init_done = true;
-        
-        this_type.sprite_sheet = "sprites/red_enemy.png";
-        this_type.frame_config =
-        {
-            0, 1, // idle
-            5, 9, // walking
-            3, 3, // jump
-            9, 9, // braking
-            2, 2, // dead
-        };
-        this_type.pad_top = 4;
-        this_type.pad_right = 3;
-        this_type.pad_bot = 0;
-        this_type.pad_left = 3;
-
-        this_type.hp = 1;
-        this_type.damage = 1;
-        this_type.score_on_destruction = 100;
-        this_type.width = 32 - this_type.pad_left - this_type.pad_right;
-        this_type.height = 32 - this_type.pad_top - this_type.pad_bot;
-        this_type.top_speed = 200 / 1000.0f;
-        this_type.max_air_jumps = 0;
-        this_type.jump_duration = 150;
-        
-        this_type.action_type = ActionType::CHARGE;
-        this_type.bump_immune = true;
-        this_type.bouncy = true;
-        this_type.hit_back_when_hopped_on = false;
-
-        this_type.walk_sound = "";
-        this_type.jump_sound = "";
-        this_type.landed_sound = "";
-        this_type.damaged_sound = "";
-        this_type.death_sound = "";
+static bool parseInts(const std::string &value, int *out, int count) {
+    const char *pos = value.c_str();
+    for (int idx = 0; idx < count; ++idx) {
+        char *end;
+        long num = std::strtol(pos, &end, 10);
+        if (end == pos || num < INT_MIN || num > INT_MAX) {
+            return false;
+        }
+        out[idx] = int(num);
+        pos = end;
     }
-    return this_type;
+    while (*pos == ' ' || *pos == '\t') {
+        ++pos;
+    }
+    return *pos == '\0';
 }
 
 /**
- Get the BeingType for a blue enemy
+ Read true or false out of value.
+ Returns false if it is neither.
  */
-BeingType& BeingType::blueEnemy() {
-    static BeingType this_type;
-    static bool init_done = false;
-    if (!init_done) {
-        init_done = true;
-        
-        this_type.sprite_sheet = "sprites/blue_enemy.png";
-        this_type.frame_config =
-        {
-            0, 1, // idle
-            5, 9, // walking
-            4, 4, // jump
-            9, 9, // braking
-            3, 3, // dead
-        };
-        this_type.pad_top = 4;
-        this_type.pad_right = 3;
-        this_type.pad_bot = 0;
-        this_type.pad_left = 3;
-
-        this_type.hp = 1;
-        this_type.damage = 1;
-        this_type.score_on_destruction = 500;
-        this_type.width = 32 - this_type.pad_left - this_type.pad_right;
-        this_type.height = 32 - this_type.pad_top - this_type.pad_bot;
-        this_type.top_speed = 150 / 1000.0f;
-        this_type.max_air_jumps = 0;
-        this_type.jump_duration = 25;
-        
-        this_type.action_type = ActionType::JUMP_AROUND;
-        this_type.bump_immune = true;
-        this_type.bouncy = true;
-        this_type.hit_back_when_hopped_on = true;
-
-        this_type.walk_sound = "";
-        this_type.jump_sound = "";
-        this_type.landed_sound = "";
-        this_type.damaged_sound = "";
-        this_type.death_sound = "";
+static bool parseBool(const std::string &value, bool &out) {
+    if (value == "true") {
+        out = true;
+    } else if (value == "false") {
+        out = false;
+    } else {
+        return false;
     }
-    return this_type;
+    return true;
 }
 
+/**
+ Constructor, no types until load() is called
+ */
+BeingRegistry::BeingRegistry() {
+    std::fill(std::begin(tile_types), std::end(tile_types), -1);
+}
+
+/**
+ Read every type from a being types file.
+ Each type is a [name] section of key = value lines.
+ Only call this before any beings are created, they point at the types it replaces.
+ */
+void BeingRegistry::load(const std::string &filename) {
+    ResourceManager &resources = ResourceManager::instance();
+    std::string text = resources.readText(filename);
+
+    std::vector<BeingType> loaded;
+    std::set<std::string> seen; // keys set in the current section
+    int section_line = 0;
+    int line = 0;
+
+    // make sure the type that was just read is complete
+    auto finishType = [&]() {
+        if (loaded.empty()) {
+            return;
+        }
+        for (const char *key : REQUIRED_KEYS) {
+            if (seen.count(key) == 0) {
+                throwTypesError(filename, section_line, loaded.back().name + " is missing " + key);
+            }
+        }
+        int tile_num = loaded.back().tile_num;
+        if (!isBeingTile(tile_num)) {
+            throwTypesError(filename, section_line, "tile " + std::to_string(tile_num) + " doesn't place a being");
+        }
+        for (size_t idx = 0; idx + 1 < loaded.size(); ++idx) {
+            if (loaded[idx].tile_num == tile_num) {
+                throwTypesError(filename, section_line, "tile " + std::to_string(tile_num) + " is already "
+                                + loaded[idx].name);
+            }
+        }
+    };
 
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find('\n', pos);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        std::string entry = text.substr(pos, end - pos);
+        pos = end + 1;
+        ++line;
+
+        size_t comment = entry.find('#');
+        if (comment != std::string::npos) {
+            entry.erase(comment);
+        }
+        entry = trim(entry);
+        if (entry.empty()) {
+            continue;
+        }
+
+        if (entry.front() == '[') {
+            if (entry.back() != ']') {
+                throwTypesError(filename, line, "expected ] at the end of the type name");
+            }
+            finishType();
+            BeingType type = {};
+            type.name = trim(entry.substr(1, entry.size() - 2));
+            type.sprite_sheet = NO_IMAGE;
+            type.walk_sound = NO_SOUND;
+            type.jump_sound = NO_SOUND;
+            type.landed_sound = NO_SOUND;
+            type.damaged_sound = NO_SOUND;
+            type.death_sound = NO_SOUND;
+            type.action_type = ActionType::NONE;
+            loaded.push_back(type);
+            seen.clear();
+            section_line = line;
+            continue;
+        }
+        if (loaded.empty()) {
+            throwTypesError(filename, line, "expected a [type] before any keys");
+        }
+
+        size_t equals = entry.find('=');
+        if (equals == std::string::npos) {
+            throwTypesError(filename, line, "expected key = value");
+        }
+        std::string key = trim(entry.substr(0, equals));
+        std::string value = trim(entry.substr(equals + 1));
+        if (!seen.insert(key).second) {
+            throwTypesError(filename, line, key + " is set twice");
+        }
+
+        BeingType &type = loaded.back();
+        FrameConfig &frames = type.frame_config;
+        bool valid = true;
+        int nums[4] = {0, 0, 0, 0};
+        if (key == "tile") {
+            valid = parseInts(value, &type.tile_num, 1);
+        } else if (key == "sprite_sheet") {
+            valid = !value.empty();
+            type.sprite_sheet = resources.getImageId(value);
+        } else if (key == "idle_frames") {
+            valid = parseInts(value, nums, 2);
+            frames.idle_frame_start = nums[0];
+            frames.idle_frame_final = nums[1];
+        } else if (key == "walking_frames") {
+            valid = parseInts(value, nums, 2);
+            frames.walking_frame_start = nums[0];
+            frames.walking_frame_final = nums[1];
+        } else if (key == "jumping_frames") {
+            valid = parseInts(value, nums, 2);
+            frames.jumping_frame_start = nums[0];
+            frames.jumping_frame_final = nums[1];
+        } else if (key == "braking_frames") {
+            valid = parseInts(value, nums, 2);
+            frames.braking_frame_start = nums[0];
+            frames.braking_frame_final = nums[1];
+        } else if (key == "dead_frames") {
+            valid = parseInts(value, nums, 2);
+            frames.dead_frame_start = nums[0];
+            frames.dead_frame_final = nums[1];
+        } else if (key == "size") {
+            valid = parseInts(value, nums, 2) && nums[0] > 0 && nums[1] > 0;
+            type.width = nums[0];
+            type.height = nums[1];
+        } else if (key == "pad") {
+            valid = parseInts(value, nums, 4);
+            type.pad_top = nums[0];
+            type.pad_right = nums[1];
+            type.pad_bot = nums[2];
+            type.pad_left = nums[3];
+        } else if (key == "hp") {
+            valid = parseInts(value, &type.hp, 1);
+        } else if (key == "damage") {
+            valid = parseInts(value, &type.damage, 1);
+        } else if (key == "score") {
+            valid = parseInts(value, &type.score_on_destruction, 1);
+        } else if (key == "top_speed") {
+            // px per second in the file, px per ms in the game
+            valid = parseInts(value, nums, 1);
+            type.top_speed = nums[0] / 1000.0f;
+        } else if (key == "jump_duration") {
+            valid = parseInts(value, nums, 1);
+            type.jump_duration = nums[0];
+        } else if (key == "max_air_jumps") {
+            valid = parseInts(value, &type.max_air_jumps, 1);
+        } else if (key == "action") {
+            if (value == "none") {
+                type.action_type = ActionType::NONE;
+            } else if (value == "charge") {
+                type.action_type = ActionType::CHARGE;
+            } else if (value == "jump_around") {
+                type.action_type = ActionType::JUMP_AROUND;
+            } else {
+                valid = false;
+            }
+        } else if (key == "bump_immune") {
+            valid = parseBool(value, type.bump_immune);
+        } else if (key == "bouncy") {
+            valid = parseBool(value, type.bouncy);
+        } else if (key == "hit_back") {
+            valid = parseBool(value, type.hit_back_when_hopped_on);
+        } else if (key == "walk_sound") {
+            type.walk_sound = resources.getSoundId(value);
+        } else if (key == "jump_sound") {
+            type.jump_sound = resources.getSoundId(value);
+        } else if (key == "landed_sound") {
+            type.landed_sound = resources.getSoundId(value);
+        } else if (key == "damaged_sound") {
+            type.damaged_sound = resources.getSoundId(value);
+        } else if (key == "death_sound") {
+            type.death_sound = resources.getSoundId(value);
+        } else {
+            throwTypesError(filename, line, "unknown key " + key);
+        }
+        if (!valid) {
+            throwTypesError(filename, line, "invalid value for " + key + ": " + value);
+        }
+    }
+    finishType();
+
+    types.swap(loaded);
+    std::fill(std::begin(tile_types), std::end(tile_types), -1);
+    for (int idx = 0; idx < int(types.size()); ++idx) {
+        tile_types[types[idx].tile_num] = idx;
+    }
+    SDL_Log("Loaded %d being types from %s\n", count(), filename.c_str());
+}
+
+/**
+ Get the type of being a tile number places, NULL if it doesn't place one
+ */
+const BeingType* BeingRegistry::forTile(int tile_num) const {
+    if (tile_num < 0 || tile_num > UINT8_MAX || tile_types[tile_num] < 0) {
+        return NULL;
+    }
+    return &types[tile_types[tile_num]];
+}
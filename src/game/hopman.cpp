@@ -6,21 +6,38 @@
 #include "hopman.h"
 
 /**
- Set up the game
+ Set up the game.
+ If hot_reload is true, levels and images are reloaded while the game runs when their files change.
+ audio_config sets the audio buffer size and whether sound effects are mixed in software.
+ seed decides what enemies do, the same seed makes them make the same choices.
+ A seed is picked and logged if it is 0.
  */
-void Hopman::init() {
+void Hopman::init(bool hot_reload, const AudioConfig &audio_config, Uint32 seed) {
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
         throw std::runtime_error("Failed to initialize SDL");
     }
 
     // init services
     ResourceManager::instance().init();
-    Graphics::instance().init(DEFAULT_WINDOW_WIDTH, DEFAULT_WINDOW_HEIGHT);
-    Audio::instance().init();
+    Graphics::instance().init(DEFAULT_WINDOW_WIDTH, DEFAULT_WINDOW_HEIGHT, WORLD_RENDER_DIVISOR);
+    Audio::instance().init(audio_config);
+    Particles::instance().init();
     Input::instance().init();
     Gui::instance().init();
+    FileWatcher::instance().init();
+    streamer.init();
+    being_types.load(BEING_TYPES_FILE);
+
+    this->hot_reload = hot_reload;
+    this->seed = seed != 0 ? seed : Uint32(SDL_GetPerformanceCounter()) | 1;
+    SDL_Log("Random seed %u, run with --seed %u to repeat it\n", this->seed, this->seed);
+    if (hot_reload) {
+        FileWatcher::instance().watch(IMAGE_DIR, true);
+        FileWatcher::instance().watch(LEVEL_DIR, false);
+    }
 
-    objects = {};
+    world.setGoalCallback(std::bind(&Hopman::hitGoal, this, std::placeholders::_1));
+    player = NO_ENTITY;
     fps_display = 0;
     paused = false;
     level = STARTING_LEVEL;
@@ -28,6 +45,36 @@ void Hopman::init() {
     fps_limit = DEFAULT_FPS_LIMIT;
     score = 0;
     lives = DEFAULT_EXTRA_LIVES;
+    ai_slice = 0;
+
+    scheduleSystems();
+}
+
+/**
+ Register each subsystem with the scheduler that runs it, at its own rate.
+ Systems run in the order they are added.
+ */
+void Hopman::scheduleSystems() {
+    systems.add("ai", AI_INTERVAL_MS, AI_BUDGET_MS, [this](int) {
+        updateAi(world, ai_slice, AI_SLICES);
+        ai_slice = (ai_slice + 1) % AI_SLICES;
+    });
+    systems.add("physics", PHYSICS_INTERVAL_MS, PHYSICS_BUDGET_MS, [this](int elapsed) {
+        // beings wait while the ground around them is still loading
+        updateFrozen(world, streamer);
+        updatePhysics(world, elapsed);
+        // damage, bounces and reaching the goal happen once everything has moved
+        updateCollisions(world);
+        // destroys beings that have fallen off the map
+        updateLifetimes(world, lower_bound);
+    });
+    systems.add("animation", ANIMATION_INTERVAL_MS, ANIMATION_BUDGET_MS, [this](int) { updateSprites(world); });
+    systems.add("emitters", EMITTER_INTERVAL_MS, EMITTER_BUDGET_MS,
+                [this](int elapsed) { updateEmitters(world, elapsed); });
+    systems.add("particles", PARTICLE_INTERVAL_MS, PARTICLE_BUDGET_MS,
+                [](int elapsed) { Particles::instance().update(elapsed); });
+
+    frame_tasks.add("gui", GUI_INTERVAL_MS, GUI_BUDGET_MS, [](int) { Gui::instance().update(); });
 }
 
 /**
@@ -35,10 +82,14 @@ void Hopman::init() {
  */
 void Hopman::shutdown() {
     cleanupLevel();
+    preloader.cancel();
+    streamer.shutdown();
 
     // shutdown services
+    FileWatcher::instance().shutdown();
     Gui::instance().shutdown();
     Input::instance().shutdown();
+    Particles::instance().shutdown();
     Audio::instance().shutdown();
     Graphics::instance().shutdown();
     ResourceManager::instance().shutdown();
@@ -53,6 +104,9 @@ int Hopman::play() {
     
     registerInputCallbacks();
     createUI();
+
+    // everything needed to start has been loaded
+    ResourceManager::instance().logLoadStats();
     
     FrameTimer timer = FrameTimer(fps_limit);
     
@@ -64,6 +118,10 @@ int Hopman::play() {
 
         // tell the input singleton to poll for events
         Input::instance().handleEvents();
+
+        if (hot_reload) {
+            applyAssetChanges();
+        }
         
         // signal a new frame to the fps timer and get the delta since the last frame
         int delta = timer.newFrame();
@@ -74,11 +132,20 @@ int Hopman::play() {
         }
 
         // focus the screen on the player
-        Graphics::instance().focusScreenOffsets(player.getRect().getCollider());
-        background.updateLayerOffsets(player.getRect().xPos(), player.getRect().yPos());
+        Graphics::instance().focusScreenOffsets(playerRect());
+        background.updateLayerOffsets(playerRect().x, playerRect().y);
+
+        // load the parts of the level coming into view
+        streamer.update(Graphics::instance().getViewRect(), world, false);
+
+        // finish assets that were loaded in the background
+        ResourceManager::instance().update();
+
+        // give the audio device a bigger buffer if it can't keep up
+        Audio::instance().update();
 
         // update the GUI
-        Gui::instance().update();
+        frame_tasks.update(delta);
 
         // draw the new frame
         render();
@@ -95,14 +162,19 @@ void Hopman::registerInputCallbacks() {
     Input::instance().registerCallback(Action::EXIT_GAME, std::bind(&Hopman::exitGame, this));
     Input::instance().registerCallback(Action::ADVACNE, std::bind(&Hopman::advanceScreen, this));
     Input::instance().registerCallback(Action::TOGGLE_FPS, std::bind(&Hopman::toggleFps, this));
+    Input::instance().registerCallback(Action::MEMORY_REPORT, std::bind(&Hopman::logMemoryReport, this));
+    Input::instance().registerCallback(Action::TIMING_REPORT, std::bind(&Hopman::logTimingReport, this));
     Input::instance().registerCallback(Action::TOGGLE_PAUSE, std::bind(&Hopman::pause, this));
+    Input::instance().registerCallback(Action::TOGGLE_FULLSCREEN,
+                                       std::bind(&Graphics::toggleFullscreen, &Graphics::instance()));
     
     // player movement
-    Input::instance().registerCallback(Action::MOVE_LEFT, std::bind(&Being::moveLeft, &player));
-    Input::instance().registerCallback(Action::STOP_LEFT, std::bind(&Being::stopLeft, &player));
-    Input::instance().registerCallback(Action::MOVE_RIGHT, std::bind(&Being::moveRight, &player));
-    Input::instance().registerCallback(Action::STOP_RIGHT, std::bind(&Being::stopRight, &player));
-    Input::instance().registerCallback(Action::JUMP, std::bind(&Being::jump, &player));
+    // the player is looked up when the key is pressed, it is a new entity after respawning
+    Input::instance().registerCallback(Action::MOVE_LEFT, [this] { moveBeingLeft(world, player); });
+    Input::instance().registerCallback(Action::STOP_LEFT, [this] { stopBeingLeft(world, player); });
+    Input::instance().registerCallback(Action::MOVE_RIGHT, [this] { moveBeingRight(world, player); });
+    Input::instance().registerCallback(Action::STOP_RIGHT, [this] { stopBeingRight(world, player); });
+    Input::instance().registerCallback(Action::JUMP, [this] { jumpBeing(world, player); });
 }
 
 /**
@@ -112,6 +184,26 @@ void Hopman::toggleFps() {
     Gui::instance().toggleGroupDisplay(GuiGroupId::FPS_DISPLAY);
 }
 
+/**
+ Write what is loaded and how much memory it takes to the log
+ */
+void Hopman::logMemoryReport() {
+    ResourceManager::instance().logMemoryReport();
+    SDL_Log("Level chunks: %d, %zu KB baked, %zu pooled, %d spare textures\n", streamer.loadedCount(),
+            streamer.bakedBytes() / 1024, streamer.pooledCount(), streamer.spareTextureCount());
+    SDL_Log("Entities: %d, %d moving\n", world.count(), world.kinematics.size());
+}
+
+/**
+ Write how long each subsystem has taken since the last report to the log
+ */
+void Hopman::logTimingReport() {
+    systems.logStats();
+    frame_tasks.logStats();
+    systems.resetStats();
+    frame_tasks.resetStats();
+}
+
 /**
  Set up the UI for the game
  */
@@ -225,45 +317,41 @@ void Hopman::setGameMessage(std::string new_msg) {
     std::string pad_str(padding, ' ');
     game_message.assign(pad_str + new_msg);
     Gui::instance().setGroupDisplay(GuiGroupId::GAME_MESSAGE, true);
+    // don't show the old message until the next scheduled GUI update
+    Gui::instance().update();
 }
 
 /**
- Update all the game objects
+ Run each system over the entities it updates
  */
 void Hopman::update(int delta) {
-    for (auto &obj : objects) {
-        obj->update(delta, objects);
-        // check if obj has fallen off the map
-        if (obj->getRect().top() > lower_bound) {
-            obj->destroy();
-        }
-    }
+    systems.update(delta);
 
-    // clean up objects that need to be removed from the game
+    // clean up entities that need to be removed from the game
     removeDestroyed();
 }
 
 /**
- Remove any objects that have been destroyed
+ Remove any entities that have been destroyed
  */
 void Hopman::removeDestroyed() {
     // check if the player was killed
-    if (player.dead() || player.needsRemoval()) {
+    if (isDead(world, player) || world.isDestroyed(player)) {
         tryRespawn();
     }
 
-    // remove destroyed objects
-    objects.erase(
-        std::remove_if(objects.begin(),
-                       objects.end(),
-                       [this](Drawable *obj) -> bool {
-                           if (obj->needsRemoval() && obj != &this->player) {
-                               this->score += obj->getScoreOnDestruction();
-                               return true;
-                           }
-                           return false;
-                       }),
-                  objects.end());
+    for (EntityId entity : world.destroyedEntities()) {
+        if (entity == player) {
+            continue;
+        }
+        const BeingType **type = world.types.find(entity);
+        if (type != NULL) {
+            score += (*type)->score_on_destruction;
+        }
+    }
+    // the player stays in the world to keep the view on it until the level is restored.
+    // beings stay in the roster so they can come back on respawn, their handles just go stale
+    world.removeDestroyed(player);
 }
 
 /**
@@ -278,7 +366,7 @@ void Hopman::tryRespawn() {
     } else {
         setGameMessage("GAME OVER :(");
         game_state = GameState::LOSS;
-        Audio::instance().playSound("game_over.wav");
+        Audio::instance().playSound("game_over.wav", SoundPriority::CRITICAL);
     }
 }
 
@@ -319,7 +407,7 @@ void Hopman::advanceScreen() {
         setupLevel();
     } else if (game_state == GameState::RESPAWN) {
         // try the level again
-        setupLevel();
+        restoreLevel();
     } else if (game_state == GameState::LEVEL_START) {
         // start the level
         Gui::instance().setGroupDisplay(GuiGroupId::GAME_MESSAGE, false);
@@ -331,11 +419,19 @@ void Hopman::advanceScreen() {
  Draw everything to the screen
  */
 void Hopman::render() {
+    // the world may be drawn at a lower resolution
+    Graphics::instance().beginWorld();
+
     background.render();
-    
-    for (auto &obj : objects) {
-        obj->render();
-    }
+
+    // tiles are drawn a chunk at a time
+    streamer.render();
+
+    renderSprites(world);
+
+    Particles::instance().render();
+
+    Graphics::instance().endWorld();
     
     renderGui();
     
@@ -350,72 +446,106 @@ void Hopman::renderGui() {
 }
 
 /**
- create a tile object at the given tile coordinates
+ create the player or an enemy at the given tile coordinates.
+ Tiles are created by the level streamer.
  */
-void Hopman::add_tile(int tile_type, int tx, int ty) {
-    if (tile_type == TileNum::EMPTY) {
+void Hopman::addBeing(int tile_type, int tx, int ty) {
+    if (being_types.forTile(tile_type) == NULL) {
         return;
     }
 
-    Drawable *obj;
-    if (tile_type == TileNum::PLAYER) {
-        player.init(BeingType::player());
-        obj = &player;
-
-    } else if (tile_type == TileNum::RED_ENEMY) {
-        Being *enemy = new Being();
-        enemy->init(BeingType::redEnemy());
-        obj = enemy;
-
-    } else if (tile_type == TileNum::BLUE_ENEMY) {
-        Being *enemy = new Being();
-        enemy->init(BeingType::blueEnemy());
-        obj = enemy;
-
-    } else {
-        Tile *tile = new Tile(tile_type);
-        if (tile_type == TileNum::GOAL) {
-            tile->setCollisionCallback(std::bind(&Hopman::hitGoal, this, std::placeholders::_1));
+    // chunks place their beings again each time they load,
+    // only ones that were parked come back, ones that are still around or were killed don't
+    auto placed = being_placements.find(std::make_tuple(tile_type, tx, ty));
+    if (placed != being_placements.end()) {
+        BeingSpawn &spawn = beings[placed->second];
+        if (spawn.parked) {
+            spawn.entity = spawnBeing(spawn);
+            spawn.parked = false;
         }
-        obj = tile;
+        return;
     }
 
     // calculate position based on tile index
-    int xpos = tx * TILE_SIDE;
-    int ypos = ty * TILE_SIDE;
-    obj->setPosition(xpos, ypos);
+    BeingSpawn spawn = {NO_ENTITY, tile_type, tx * TILE_SIDE, ty * TILE_SIDE, false};
+    spawn.entity = spawnBeing(spawn);
+    being_placements.insert({std::make_tuple(tile_type, tx, ty), beings.size()});
+    beings.push_back(spawn);
+}
+
+/**
+ Take the beings in the area of a chunk that was unloaded out of the world,
+ so beings in parts of the level that were passed don't stay in the world.
+ They are placed again when the chunk they were placed in loads again.
+ The player and beings that have been hurt are left alone.
+ */
+void Hopman::parkBeings(const SDL_Rect &rect) {
+    for (auto &spawn : beings) {
+        if (spawn.tile_type == TileNum::PLAYER || !world.isValid(spawn.entity) || world.isDestroyed(spawn.entity)
+            || world.health.get(spawn.entity).hp < being_types.forTile(spawn.tile_type)->hp) {
+            continue;
+        }
+        const SDL_Rect &box = world.colliders.get(spawn.entity).box;
+        SDL_Point center = {box.x + box.w / 2, box.y + box.h / 2};
+        if (SDL_PointInRect(&center, &rect)) {
+            world.remove(spawn.entity);
+            spawn.parked = true;
+        }
+    }
+}
 
-    objects.push_back(obj);
+/**
+ Create a being where it was placed in the level, returns its entity
+ */
+EntityId Hopman::spawnBeing(const BeingSpawn &spawn) {
+    EntityId entity = world.createBeing(*being_types.forTile(spawn.tile_type), spawn.x_pos, spawn.y_pos);
+    if (spawn.tile_type == TileNum::PLAYER) {
+        player = entity;
+    }
+    return entity;
 }
 
 /**
  Called when something hits a goal tile.
  If its the player then they beat the level
  */
-void Hopman::hitGoal(Drawable& other) {
-    if (&other == &player) {
+void Hopman::hitGoal(EntityId other) {
+    if (other == player && game_state != GameState::LEVEL_WON) {
         setGameMessage("YOU WIN!");
         game_state = GameState::LEVEL_WON;
-        Audio::instance().playSound("you_win.wav");
+        Audio::instance().playSound("you_win.wav", SoundPriority::CRITICAL);
+
+        // get the next level ready while the win screen is showing
+        preloadNextLevel();
     }
 }
 
+/**
+ Start loading the next level in the background
+ */
+void Hopman::preloadNextLevel() {
+    std::vector<std::string> image_names;
+    for (auto &layer : BG_LAYERS) {
+        image_names.push_back(layer.img_file);
+    }
+    // images the levels share are already loaded, only new ones are decoded
+    preloader.start(LEVEL_FILE_PREFIX, level + 1, image_names, ResourceManager::instance().getLoadedImageNames(),
+                    Graphics::instance().getWindowWidth(), Graphics::instance().getWindowHeight());
+}
+
 /**
  Set up a parallax background
  */
 void Hopman::createBackground() {
     int sw = Graphics::instance().getWindowWidth();
     int sh = Graphics::instance().getWindowHeight();
-    background.init(player.getRect().xPos(), player.getRect().yPos(), lower_bound - 200);
-    background.setColor(125, 90, 125);
+    background.init(playerRect().x, playerRect().y, lower_bound - 200);
+    background.setColor(BG_COLOR[0], BG_COLOR[1], BG_COLOR[2]);
     
     // add layers at different distances
-    background.addLayer("background/dusk/layer_0.png", sw, sh, 60);
-    background.addLayer("background/dusk/layer_1.png", sw, sh, 30);
-    background.addLayer("background/dusk/layer_2.png", sw, sh, 20);
-    background.addLayer("background/dusk/layer_3.png", sw, sh, 16);
-    background.addLayer("background/dusk/layer_4.png", sw, sh, 6);
-    background.addLayer("background/dusk/layer_5.png", sw, sh, 2);
+    for (auto &layer : BG_LAYERS) {
+        background.addLayer(layer.img_file, sw, sh, layer.distance);
+    }
 }
 
 /**
@@ -425,32 +555,100 @@ void Hopman::setupLevel() {
     // cleanup previous level
     cleanupLevel();
 
-    LevelConfig lvl_conf;
-    parseLevelConfig(lvl_conf);
-
-    // instantiate level objects
-    bool have_player = false;
-    bool have_goal = false;
-    for (int tx = 0; tx < lvl_conf.tiles.size(); ++tx) {
-        for (int ty = 0; ty < lvl_conf.tiles[0].size(); ++ty) {
-            int tile_num = lvl_conf.tiles[tx][ty];
-            if (tile_num == TileNum::PLAYER) {
-                have_player = true;
-            } else if (tile_num == TileNum::GOAL) {
-                have_goal = true;
+    // use the level loaded during the win screen if there is one
+    if (!preloader.take(level, level_config, preloaded_chunks)) {
+        parseLevelConfig(level_config);
+    }
+
+    buildLevel();
+}
+
+/**
+ Hold the images and sounds the level uses until the next level replaces them,
+ which frees the ones only the previous level used.
+ Sprite sheets and sounds of every being in the level start loading in the background,
+ so they are ready by the time the beings come into view.
+ */
+void Hopman::preloadLevelAssets() {
+    ResourceManager &resources = ResourceManager::instance();
+    std::vector<ImageId> images;
+    std::vector<SoundId> sounds;
+    for (int tile_num = 0; tile_num <= UINT8_MAX; ++tile_num) {
+        if (!level_config.usesTile(tile_num) || tile_num == TileNum::EMPTY) {
+            continue;
+        }
+        const BeingType *type = being_types.forTile(tile_num);
+        if (type == NULL) {
+            images.push_back(resources.getImageId(tileTextureName(tile_num)));
+            continue;
+        }
+        images.push_back(type->sprite_sheet);
+        for (SoundId sound : {type->walk_sound, type->jump_sound, type->landed_sound,
+                              type->damaged_sound, type->death_sound}) {
+            if (sound != NO_SOUND) {
+                sounds.push_back(sound);
             }
-            add_tile(tile_num, tx, ty);
         }
     }
+    for (auto &layer : BG_LAYERS) {
+        images.push_back(resources.getImageId(layer.img_file));
+    }
+    sounds.push_back(resources.getSoundId("game_over.wav"));
+    sounds.push_back(resources.getSoundId("you_win.wav"));
+
+    // beings of different types can share sounds
+    std::sort(sounds.begin(), sounds.end());
+    sounds.erase(std::unique(sounds.begin(), sounds.end()), sounds.end());
+    resources.setLevelAssets(images, sounds);
+
+    for (int tile_num = 0; tile_num <= UINT8_MAX; ++tile_num) {
+        const BeingType *type = being_types.forTile(tile_num);
+        if (type != NULL && level_config.usesTile(tile_num)) {
+            resources.loadImageAsync(resources.getImageName(type->sprite_sheet), resources.getPlaceholderImage());
+        }
+    }
+    for (SoundId sound : sounds) {
+        resources.loadSoundAsync(resources.getSoundName(sound));
+    }
+}
+
+/**
+ Create the level that is in level_config
+ */
+void Hopman::buildLevel() {
+    // set lower bound of level
+    lower_bound = level_config.getHeight() * TILE_SIDE;
+
+    // beings get their random numbers from the level seed
+    world.setSeed(mixSeed(seed, Uint32(level)));
 
     // make sure we have a player tile in the level
-    if (!have_player) {
+    int player_tx, player_ty;
+    if (!level_config.findTile(TileNum::PLAYER, player_tx, player_ty)) {
         throw std::runtime_error("Invalid level file, no player tile found!");
     }
     // make sure we have a goal tile in the level
-    if (!have_goal) {
+    int goal_tx, goal_ty;
+    if (!level_config.findTile(TileNum::GOAL, goal_tx, goal_ty)) {
         throw std::runtime_error("Invalid level file, no goal tile found!");
     }
+    preloadLevelAssets();
+    addBeing(TileNum::PLAYER, player_tx, player_ty);
+
+    // the rest of the level is created chunk by chunk as it comes into view
+    streamer.start(level_config,
+                   std::bind(&Hopman::addBeing, this, std::placeholders::_1,
+                             std::placeholders::_2, std::placeholders::_3),
+                   std::bind(&Hopman::parkBeings, this, std::placeholders::_1));
+
+    // load everything around the player before the level starts,
+    // with room for the tiles that can be loaded at once so the world never grows while playing
+    Graphics::instance().focusScreenOffsets(playerRect());
+    world.reserve(streamer.maxLoadedTiles(Graphics::instance().getViewRect()) + level_config.getEntityCount() + 1);
+    // a preloaded level has the chunks around the start listed already
+    streamer.addChunks(preloaded_chunks, world);
+    preloaded_chunks.clear();
+    streamer.update(Graphics::instance().getViewRect(), world, true);
 
     // setup background layers
     createBackground();
@@ -465,6 +663,113 @@ void Hopman::setupLevel() {
     game_state = GameState::LEVEL_START;
 }
 
+/**
+ Put the level back the way it started after the player dies.
+ Every being that has been created is made again where it was placed, the tiles are left alone.
+ Nothing is reloaded, beings placed in chunks that aren't loaded are made when their chunk loads.
+ */
+void Hopman::restoreLevel() {
+    Gui::instance().setGroupDisplay(GuiGroupId::GAME_MESSAGE, false);
+    Particles::instance().clear();
+
+    for (auto &spawn : beings) {
+        // does nothing if it was already removed
+        world.remove(spawn.entity);
+    }
+    for (auto &spawn : beings) {
+        // beings in chunks that aren't loaded are placed when their chunk loads
+        spawn.parked = spawn.tile_type != TileNum::PLAYER && !streamer.isChunkLoaded(spawn.x_pos, spawn.y_pos);
+        spawn.entity = spawn.parked ? NO_ENTITY : spawnBeing(spawn);
+    }
+
+    // load everything around the player before the level starts,
+    // with room for the tiles that can be loaded at once so the world never grows while playing
+    Graphics::instance().focusScreenOffsets(playerRect());
+    world.reserve(streamer.maxLoadedTiles(Graphics::instance().getViewRect()) + level_config.getEntityCount() + 1);
+    streamer.update(Graphics::instance().getViewRect(), world, true);
+
+    setGameMessage("Level " + std::to_string(level));
+    game_state = GameState::LEVEL_START;
+}
+
+/**
+ Reload any levels and images that changed on disk
+ */
+void Hopman::applyAssetChanges() {
+    const std::vector<std::string> &changed = FileWatcher::instance().poll();
+    if (changed.empty()) {
+        return;
+    }
+
+    Uint64 reload_start = SDL_GetPerformanceCounter();
+    std::string image_dir = IMAGE_DIR;
+    std::string level_dir = LEVEL_DIR;
+    bool images_changed = false;
+    // files that aren't in use are ignored
+    int applied = 0;
+    for (auto &path : changed) {
+        try {
+            if (path.compare(0, image_dir.size(), image_dir) == 0) {
+                if (ResourceManager::instance().reloadImage(path.substr(image_dir.size()))) {
+                    images_changed = true;
+                    ++applied;
+                }
+            } else if (path.compare(0, level_dir.size(), level_dir) == 0) {
+                if (reloadLevelFile(path)) {
+                    ++applied;
+                }
+            }
+        } catch (std::exception &ex) {
+            // a half saved file shouldn't take the game down
+            SDL_Log("Failed to reload %s: %s\n", path.c_str(), ex.what());
+        }
+    }
+
+    if (images_changed) {
+        // chunks have the old tile images baked in
+        streamer.rebake();
+    }
+    if (applied > 0) {
+        double reload_ms = (SDL_GetPerformanceCounter() - reload_start) * 1000.0 / SDL_GetPerformanceFrequency();
+        SDL_Log("Reloaded %d changed files in %.3f ms\n", applied, reload_ms);
+    }
+}
+
+/**
+ Apply a changed level file to the running level, if it is the one being played.
+ Only tiles that changed are rebuilt, unless the size or format of the level changed.
+ Returns false if it isn't the level being played.
+ */
+bool Hopman::reloadLevelFile(const std::string &path) {
+    const std::string &current = level_config.getFilename();
+    // saving the text level also applies when playing its compiled version
+    if (path != current && path + LEVEL_BIN_SUFFIX != current) {
+        return false;
+    }
+
+    std::string bin_suffix = LEVEL_BIN_SUFFIX;
+    bool compiled = path.size() > bin_suffix.size()
+                    && path.compare(path.size() - bin_suffix.size(), bin_suffix.size(), bin_suffix) == 0;
+    LevelConfig fresh;
+    if (compiled) {
+        fresh.loadBinary(path);
+    } else {
+        fresh.loadText(path);
+    }
+
+    if (path != current || fresh.getWidth() != level_config.getWidth()
+        || fresh.getHeight() != level_config.getHeight()) {
+        // the format or size changed, start the level over
+        SDL_Log("Restarting level from %s\n", path.c_str());
+        cleanupLevel();
+        level_config.swap(fresh);
+        buildLevel();
+    } else {
+        streamer.reload(fresh, world);
+    }
+    return true;
+}
+
 /**
  Read a level config file and fill in the passed in config struct
  */
@@ -472,68 +777,40 @@ void Hopman::parseLevelConfig(LevelConfig &config) {
     // find the largest level file that is <= level
     // this lets you repeat levels by skipping some filenames
     // you must at least provide a level_1 file
-    // wanted to read all files from the level directory, but OSX still doesn't
-    // have support for std::filesystem
-    std::ifstream cfg_stream("");
-    int effective_lvl = level;
-    while (effective_lvl >= 0 && !cfg_stream.good()) {
-        // see if we can load this level file
-        std::string lvl_file = LEVEL_FILE_PREFIX + std::to_string(effective_lvl);
-        cfg_stream.open(lvl_file);
-        --effective_lvl;
-    }
+    bool compiled = false;
+    std::string lvl_file = findLevelFile(LEVEL_FILE_PREFIX, level, compiled);
     
-    if (!cfg_stream.good()) {
+    if (lvl_file.empty()) {
         // couldn't load any level files
         throw std::runtime_error("Failed to find a level config file");
     }
-    
-    try {
-        std::string line;
-        
-        // first line is level dimensions
-        std::getline(cfg_stream, line);
-        std::stringstream ss(line);
-        std::string tok;
-        ss >> tok;
-        int level_width = std::stoi(tok);
-        ss >> tok;
-        int level_height = std::stoi(tok);
-        
-        // set lower bound of level
-        lower_bound = level_height * TILE_SIDE;
-
-        // initialize the size of the 2d vector of tiles
-        config.tiles.resize(level_width, std::vector<int>(level_height, TileNum::EMPTY));
-
-        // read line by line
-        int xt = 0, yt = 0; // tile indicies
-        while (std::getline(cfg_stream, line)) {
-            std::stringstream line_stream(line);
-            std::string tile_str;
-            while (std::getline(line_stream, tile_str, ' ')) {
-                config.tiles.at(xt).at(yt) = std::stoi(tile_str);
-                ++xt;
-            }
-            ++yt;
-            xt = 0;
-        }
-    } catch (const std::exception &ex) {
-        throw std::runtime_error(std::string("Failed to parse config file: %s") + ex.what());
+
+    Uint64 load_start = SDL_GetPerformanceCounter();
+    if (compiled) {
+        config.loadBinary(lvl_file);
+    } else {
+        config.loadText(lvl_file);
     }
+    double load_ms = (SDL_GetPerformanceCounter() - load_start) * 1000.0 / SDL_GetPerformanceFrequency();
+    SDL_Log("Loaded %s (%dx%d) in %.3f ms\n", lvl_file.c_str(), config.getWidth(), config.getHeight(), load_ms);
 }
 
 /**
- Remove objects at the end of a level or loss
+ Remove every entity at the end of a level or loss
  */
 void Hopman::cleanupLevel() {
-    // deallocate everything in the drawable list
-    for (auto &obj : objects) {
-        if (obj != &player) {
-            delete obj;
-        }
-    }
-    objects.clear();
+    // the streamer frees its own chunks
+    streamer.clear(world);
+
+    // the level's sounds may be freed once it is replaced
+    Audio::instance().flush();
+
+    beings.clear();
+    being_placements.clear();
+    world.clear();
+    player = NO_ENTITY;
+
+    Particles::instance().clear();
 
     Gui::instance().setGroupDisplay(GuiGroupId::GAME_MESSAGE, false);
 
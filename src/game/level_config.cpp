@@ -0,0 +1,383 @@
+//
+//  Copyright © 2018 Vande Griek, Eric. All rights reserved.
+//
+
+#include <climits>
+#include <algorithm>
+#include <cstring>
+#include <charconv>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "level_config.h"
+
+/**
+ Create an empty config
+ */
+LevelConfig::LevelConfig()
+: width(0), height(0), tiles(NULL), entity_count(0), entities(NULL), map_addr(NULL), map_len(0) {
+    std::fill(std::begin(tile_used), std::end(tile_used), false);
+}
+
+/**
+ Unmap the level file if it was mapped
+ */
+LevelConfig::~LevelConfig() {
+    unload();
+}
+
+/**
+ Release whatever is backing the current level
+ */
+void LevelConfig::unload() {
+    if (map_addr != NULL) {
+        munmap(map_addr, map_len);
+        map_addr = NULL;
+        map_len = 0;
+    }
+    tile_storage.clear();
+    tiles = NULL;
+    entities = NULL;
+    entity_count = 0;
+    width = 0;
+    height = 0;
+    std::fill(std::begin(tile_used), std::end(tile_used), false);
+    filename.clear();
+}
+
+/**
+ Exchange levels with another config, such as one loaded in the background
+ */
+void LevelConfig::swap(LevelConfig &other) {
+    // swapping the vectors keeps their data where it is, so tiles stays valid
+    std::swap(width, other.width);
+    std::swap(height, other.height);
+    std::swap(tiles, other.tiles);
+    std::swap(entity_count, other.entity_count);
+    std::swap(entities, other.entities);
+    std::swap(tile_used, other.tile_used);
+    filename.swap(other.filename);
+    tile_storage.swap(other.tile_storage);
+    std::swap(map_addr, other.map_addr);
+    std::swap(map_len, other.map_len);
+}
+
+/**
+ Map a whole file read-only.
+ Fills in map_addr and map_len, which are released by unload().
+ */
+void LevelConfig::mapFile(const std::string &filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open level file: " + filename);
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+        close(fd);
+        throw std::runtime_error("Level file is empty: " + filename);
+    }
+    size_t file_len = file_stat.st_size;
+    void *addr = mmap(NULL, file_len, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping stays valid after the descriptor is closed
+    close(fd);
+    if (addr == MAP_FAILED) {
+        throw std::runtime_error("Failed to map level file: " + filename);
+    }
+    map_addr = addr;
+    map_len = file_len;
+}
+
+/**
+ Throw an error for a text level, pointing at the line and column where it was found
+ */
+[[noreturn]] static void throwParseError(const std::string &filename, int line, int column,
+                                         const std::string &msg) {
+    throw std::runtime_error("Failed to parse level file " + filename + ":" + std::to_string(line)
+                             + ":" + std::to_string(column) + ": " + msg);
+}
+
+/**
+ True for characters that can end a number in a text level
+ */
+static inline bool isSeparator(char chr) {
+    return chr == ' ' || chr == '\t' || chr == '\r' || chr == '\n';
+}
+
+/**
+ Parse a non-negative number in a text level and move pos past it.
+ Returns -1 and leaves pos alone if there is no number, or if it is not followed by a separator.
+ */
+static inline long long parseNumber(const char *&pos, const char *end) {
+    // almost every tile is a single digit, skip from_chars for those
+    if (end - pos >= 2 && *pos >= '0' && *pos <= '9' && isSeparator(pos[1])) {
+        return *pos++ - '0';
+    }
+    long long value = 0;
+    std::from_chars_result result = std::from_chars(pos, end, value);
+    if (result.ec != std::errc() || value < 0 || (result.ptr < end && !isSeparator(*result.ptr))) {
+        return -1;
+    }
+    pos = result.ptr;
+    return value;
+}
+
+/**
+ Read a level from the text format written by the level editor.
+ The first line is the level dimensions, followed by one line of tile numbers per row.
+ Parsed in a single pass over the mapped file straight into the flat tile array.
+ Errors report the line and column they were found at.
+ */
+void LevelConfig::loadText(const std::string &filename) {
+    unload();
+    mapFile(filename);
+
+    const char *pos = static_cast<const char*>(map_addr);
+    const char *end = pos + map_len;
+    const char *line_start = pos;
+    int line = 1;
+
+    // errors point at pos, the start of the token being read
+    auto fail = [&](const std::string &msg) {
+        int column = int(pos - line_start) + 1;
+        unload();
+        throwParseError(filename, line, column, msg);
+    };
+
+    // first line is level dimensions
+    long long dims[2];
+    for (long long &dim : dims) {
+        while (pos < end && (*pos == ' ' || *pos == '\t')) {
+            ++pos;
+        }
+        dim = parseNumber(pos, end);
+        if (dim <= 0 || dim > INT_MAX) {
+            fail("expected the level width and height");
+        }
+    }
+    int file_width = int(dims[0]);
+    int file_height = int(dims[1]);
+    while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r')) {
+        ++pos;
+    }
+    if (pos < end && *pos != '\n') {
+        fail("expected the end of the dimensions line");
+    }
+    if (file_width > INT_MAX / file_height) {
+        fail("level dimensions are too large");
+    }
+
+    tile_storage.resize(size_t(file_width) * file_height);
+    Uint8 *out = tile_storage.data();
+    for (int ty = 0; ty < file_height; ++ty) {
+        // move past the end of the previous line
+        if (pos == end) {
+            fail("expected " + std::to_string(file_height) + " rows, found " + std::to_string(ty));
+        }
+        ++pos;
+        ++line;
+        line_start = pos;
+
+        for (int tx = 0; tx < file_width; ++tx) {
+            while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r')) {
+                ++pos;
+            }
+            if (pos == end || *pos == '\n') {
+                if (tx == 0 && pos == end) {
+                    fail("expected " + std::to_string(file_height) + " rows, found " + std::to_string(ty));
+                }
+                fail("row has " + std::to_string(tx) + " tiles, expected " + std::to_string(file_width));
+            }
+            const char *token = pos;
+            long long tile_num = parseNumber(pos, end);
+            if (tile_num < 0) {
+                fail("expected a tile number");
+            } else if (tile_num > UINT8_MAX) {
+                pos = token;
+                fail("tile number " + std::to_string(tile_num) + " is out of range");
+            }
+            *out++ = Uint8(tile_num);
+            tile_used[tile_num] = true;
+        }
+
+        while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r')) {
+            ++pos;
+        }
+        if (pos < end && *pos != '\n') {
+            fail("row has more than " + std::to_string(file_width) + " tiles");
+        }
+    }
+
+    // only blank lines may follow the last row
+    while (pos < end) {
+        if (*pos == '\n') {
+            ++line;
+            line_start = pos + 1;
+        } else if (*pos != ' ' && *pos != '\t' && *pos != '\r') {
+            fail("unexpected data after the last row");
+        }
+        ++pos;
+    }
+
+    // the text is not needed after parsing
+    munmap(map_addr, map_len);
+    map_addr = NULL;
+    map_len = 0;
+
+    width = file_width;
+    height = file_height;
+    tiles = tile_storage.data();
+    this->filename = filename;
+}
+
+/**
+ Map a compiled level file into memory.
+ Tiles and entities are read straight out of the mapping, nothing is copied.
+ */
+void LevelConfig::loadBinary(const std::string &filename) {
+    unload();
+    mapFile(filename);
+    if (map_len < sizeof(LevelFileHeader)) {
+        unload();
+        throw std::runtime_error("Level file is too small: " + filename);
+    }
+    size_t file_len = map_len;
+
+    const Uint8 *data = static_cast<const Uint8*>(map_addr);
+    LevelFileHeader header;
+    SDL_memcpy(&header, data, sizeof(header));
+    Uint32 file_width = SDL_SwapLE32(header.width);
+    Uint32 file_height = SDL_SwapLE32(header.height);
+    Uint32 file_entity_count = SDL_SwapLE32(header.entity_count);
+    Uint32 file_entity_offset = SDL_SwapLE32(header.entity_offset);
+
+    // validate before pointing into the file
+    std::string error;
+    Uint64 tiles_end = sizeof(header) + Uint64(file_width) * file_height;
+    Uint64 entities_end = file_entity_offset + Uint64(file_entity_count) * sizeof(LevelEntity);
+    if (SDL_memcmp(header.magic, LEVEL_BIN_MAGIC, sizeof(header.magic)) != 0) {
+        error = "bad magic";
+    } else if (SDL_SwapLE16(header.version) != LEVEL_BIN_VERSION) {
+        error = "unsupported version " + std::to_string(SDL_SwapLE16(header.version));
+    } else if (file_width == 0 || file_height == 0 || file_width > INT_MAX / file_height) {
+        error = "bad dimensions";
+    } else if (tiles_end > file_len) {
+        error = "tile data is truncated";
+    } else if (file_entity_count > 0 && (file_entity_offset < tiles_end || entities_end > file_len)) {
+        error = "entity data is out of bounds";
+    }
+    if (!error.empty()) {
+        unload();
+        throw std::runtime_error("Failed to parse level file " + filename + ": " + error);
+    }
+
+    width = file_width;
+    height = file_height;
+    tiles = data + sizeof(header);
+    entity_count = file_entity_count;
+    entities = data + file_entity_offset;
+    this->filename = filename;
+
+    size_t tile_count = size_t(width) * height;
+    for (size_t idx = 0; idx < tile_count; ++idx) {
+        tile_used[tiles[idx]] = true;
+    }
+    for (int idx = 0; idx < entity_count; ++idx) {
+        tile_used[getEntity(idx).type] = true;
+    }
+}
+
+/**
+ Get an entity that is stored outside of the tile grid
+ */
+LevelEntity LevelConfig::getEntity(int idx) const {
+    LevelEntity entity;
+    SDL_memcpy(&entity, entities + idx * sizeof(LevelEntity), sizeof(entity));
+    entity.tx = SDL_SwapLE32(entity.tx);
+    entity.ty = SDL_SwapLE32(entity.ty);
+    return entity;
+}
+
+/**
+ Find the first place a tile number is used, in the tile grid or as an entity.
+ Returns false if it isn't in the level.
+ */
+bool LevelConfig::findTile(int tile_num, int &tx, int &ty) const {
+    size_t tile_count = size_t(width) * height;
+    const void *found = std::memchr(tiles, tile_num, tile_count);
+    if (found != NULL) {
+        size_t offset = static_cast<const Uint8*>(found) - tiles;
+        tx = int(offset % width);
+        ty = int(offset / width);
+        return true;
+    }
+    for (int idx = 0; idx < entity_count; ++idx) {
+        LevelEntity entity = getEntity(idx);
+        if (entity.type == tile_num) {
+            tx = entity.tx;
+            ty = entity.ty;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ Find the file for a level.
+ Uses the largest level number <= level that has a file,
+ so levels can be repeated by skipping some numbers.
+ A compiled level is used over the text level with the same number.
+ Returns an empty string if there are none.
+ */
+std::string findLevelFile(const std::string &prefix, int level, bool &compiled) {
+    // wanted to read all files from the level directory, but OSX still doesn't
+    // have support for std::filesystem
+    for (int effective_lvl = level; effective_lvl >= 0; --effective_lvl) {
+        std::string text_file = prefix + std::to_string(effective_lvl);
+        std::string bin_file = text_file + LEVEL_BIN_SUFFIX;
+        if (std::ifstream(bin_file).good()) {
+            compiled = true;
+            return bin_file;
+        } else if (std::ifstream(text_file).good()) {
+            compiled = false;
+            return text_file;
+        }
+    }
+    return "";
+}
+
+/**
+ Time loading a level in both formats.
+ filename is the text level, the compiled one is expected next to it.
+ Results are written to the log.
+ */
+void benchmarkLevelLoading(const std::string &filename, int iterations) {
+    std::string bin_filename = filename + LEVEL_BIN_SUFFIX;
+    std::string names[] = {filename, bin_filename};
+    for (int fmt = 0; fmt < 2; ++fmt) {
+        if (!std::ifstream(names[fmt]).good()) {
+            SDL_Log("%s: not found, skipping\n", names[fmt].c_str());
+            continue;
+        }
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        int checksum = 0;
+        for (int run = 0; run < iterations; ++run) {
+            LevelConfig config;
+            if (fmt == 0) {
+                config.loadText(names[fmt]);
+            } else {
+                config.loadBinary(names[fmt]);
+            }
+            // touch every tile like setting up the level would
+            for (int ty = 0; ty < config.getHeight(); ++ty) {
+                for (int tx = 0; tx < config.getWidth(); ++tx) {
+                    checksum += config.tileAt(tx, ty);
+                }
+            }
+        }
+        double elapsed_ms = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+        SDL_Log("%s: %.3f ms per load over %d loads (checksum %d)\n",
+                names[fmt].c_str(), elapsed_ms / iterations, iterations, checksum);
+    }
+}
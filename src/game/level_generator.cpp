@@ -0,0 +1,107 @@
+//
+//  Copyright © 2018 Vande Griek, Eric. All rights reserved.
+//
+
+#include <fstream>
+#include <algorithm>
+#include "level_generator.h"
+#include "xorshift.h"
+
+/**
+ Make a level from a seed.
+ The same params always make the same level.
+ The level has solid ground along the bottom with fire tiles mixed in,
+ rows of floating platforms, and enemies standing on top of things.
+ The player starts at the left end and the goal is at the right end, both on safe ground.
+ */
+GeneratedLevel generateLevel(const LevelGenParams &params) {
+    if (params.width < GEN_MIN_WIDTH || params.height < GEN_MIN_HEIGHT) {
+        throw std::runtime_error("Generated levels must be at least " + std::to_string(GEN_MIN_WIDTH)
+                                 + "x" + std::to_string(GEN_MIN_HEIGHT));
+    }
+    if (size_t(params.width) * params.height > size_t(INT32_MAX)) {
+        throw std::runtime_error("Generated level is too large");
+    }
+
+    XorShift rng(params.seed);
+    GeneratedLevel level;
+    level.width = params.width;
+    level.height = params.height;
+    level.tiles.assign(size_t(level.width) * level.height, TileNum::EMPTY);
+    auto tile = [&level](int tx, int ty) -> Uint8& { return level.tiles[size_t(ty) * level.width + tx]; };
+
+    // ground along the bottom, with fire away from the ends
+    int ground_y = level.height - 1;
+    for (int tx = 0; tx < level.width; ++tx) {
+        bool safe = tx < GEN_SAFE_COLUMNS || tx >= level.width - GEN_SAFE_COLUMNS;
+        tile(tx, ground_y) = !safe && rng.chance(params.hazard_density) ? TileNum::DAMAGE : TileNum::DIRT;
+    }
+
+    // platforms on every few rows, leaving room to stand under the lowest ones
+    for (int ty = ground_y - GEN_PLATFORM_ROW_GAP; ty >= 2; ty -= GEN_PLATFORM_ROW_GAP) {
+        int tx = 0;
+        while (tx < level.width) {
+            if (!rng.chance(params.platform_density)) {
+                ++tx;
+                continue;
+            }
+            int len = rng.range(GEN_PLATFORM_MIN_LEN, GEN_PLATFORM_MAX_LEN);
+            Uint8 tile_num = rng.chance(0.5f) ? TileNum::DIRT : TileNum::STEEL;
+            int end = std::min(tx + len, level.width);
+            for (; tx < end; ++tx) {
+                tile(tx, ty) = tile_num;
+            }
+            // leave a gap before the next platform
+            tx += 1;
+        }
+    }
+
+    // enemies stand on solid tiles with open space above
+    for (int ty = 0; ty < ground_y; ++ty) {
+        for (int tx = GEN_SAFE_COLUMNS; tx < level.width - GEN_SAFE_COLUMNS; ++tx) {
+            int below = tile(tx, ty + 1);
+            if (tile(tx, ty) != TileNum::EMPTY || (below != TileNum::DIRT && below != TileNum::STEEL)) {
+                continue;
+            }
+            if (rng.chance(params.enemy_density)) {
+                tile(tx, ty) = rng.chance(0.5f) ? TileNum::RED_ENEMY : TileNum::BLUE_ENEMY;
+            }
+        }
+    }
+
+    // player at the left end and the goal at the right, both standing on the ground
+    for (int ty = 0; ty < ground_y; ++ty) {
+        tile(1, ty) = TileNum::EMPTY;
+        tile(level.width - 2, ty) = TileNum::EMPTY;
+    }
+    tile(1, ground_y - 1) = TileNum::PLAYER;
+    tile(level.width - 2, ground_y - 1) = TileNum::GOAL;
+
+    return level;
+}
+
+/**
+ Write the level in the text level format.
+ Built up in memory and written in one go so huge levels save quickly.
+ */
+void GeneratedLevel::saveText(const std::string &filename) const {
+    std::string text = std::to_string(width) + " " + std::to_string(height) + "\n";
+    text.reserve(text.size() + tiles.size() * 2);
+    for (int ty = 0; ty < height; ++ty) {
+        for (int tx = 0; tx < width; ++tx) {
+            int tile_num = tiles[size_t(ty) * width + tx];
+            if (tile_num < 10) {
+                text += char('0' + tile_num);
+            } else {
+                text += std::to_string(tile_num);
+            }
+            text += tx + 1 < width ? ' ' : '\n';
+        }
+    }
+
+    std::ofstream out(filename, std::ios::binary);
+    out.write(text.data(), text.size());
+    if (!out.good()) {
+        throw std::runtime_error("Failed to write level file: " + filename);
+    }
+}
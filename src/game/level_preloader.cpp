@@ -0,0 +1,154 @@
+//
+//  Copyright © 2018 Vande Griek, Eric. All rights reserved.
+//
+
+#include "level_preloader.h"
+
+/**
+ Create an idle preloader
+ */
+LevelPreloader::LevelPreloader() {}
+
+/**
+ Stop any load that is still running
+ */
+LevelPreloader::~LevelPreloader() {
+    cancel();
+}
+
+/**
+ Start loading a level on a worker thread.
+ The level file is found the same way as for a normal load, starting from level.
+ image_names are decoded along with the images for the level's tiles,
+ except ones in loaded_images, which the main thread already has.
+ The chunks of a view_w by view_h view around the player's start are listed too.
+ Replaces any preload already in progress.
+ */
+void LevelPreloader::start(const std::string &prefix, int level, const std::vector<std::string> &image_names,
+                           const std::set<std::string> &loaded_images, int view_w, int view_h) {
+    cancel();
+    this->level = level;
+    level_prefix = prefix;
+    extra_images = image_names;
+    this->loaded_images = loaded_images;
+    this->view_w = view_w;
+    this->view_h = view_h;
+    done = false;
+    worker = std::thread(&LevelPreloader::load, this);
+}
+
+/**
+ Runs on the worker thread.
+ Errors are saved so the main thread can fall back to loading the level itself.
+ */
+void LevelPreloader::load() {
+    try {
+        bool compiled;
+        filename = findLevelFile(level_prefix, level, compiled);
+        if (filename.empty()) {
+            throw std::runtime_error("Failed to find a level config file");
+        }
+        Uint64 load_start = SDL_GetPerformanceCounter();
+        if (compiled) {
+            config.loadBinary(filename);
+        } else {
+            config.loadText(filename);
+        }
+        load_ms = (SDL_GetPerformanceCounter() - load_start) * 1000.0 / SDL_GetPerformanceFrequency();
+
+        std::vector<std::string> image_names = extra_images;
+        for (int tile_num = TileNum::EMPTY + 1; tile_num <= UINT8_MAX; ++tile_num) {
+            if (config.usesTile(tile_num) && !isBeingTile(tile_num)) {
+                image_names.push_back(tileTextureName(tile_num));
+            }
+        }
+        for (auto &name : image_names) {
+            if (loaded_images.count(name) > 0) {
+                continue;
+            }
+            SDL_Surface *surf = ResourceManager::instance().decodeImage(name);
+            if (surf == NULL) {
+                throw std::runtime_error("Failed to load image: " + name);
+            }
+            images.push_back({name, surf});
+        }
+
+        // the view is centered on the player's tile like Graphics::focusScreenOffsets,
+        // missing chunks if it is off a little are built when the level starts
+        int player_tx, player_ty;
+        if (config.findTile(TileNum::PLAYER, player_tx, player_ty)) {
+            SDL_Rect view = {player_tx * TILE_SIDE + TILE_SIDE / 2 - view_w / 2,
+                             player_ty * TILE_SIDE + TILE_SIDE / 2 - (3 * view_h) / 4, view_w, view_h};
+            for (int index : LevelStreamer::chunksAround(config, view)) {
+                chunks.emplace_back();
+                LevelStreamer::listChunk(config, index, chunks.back());
+            }
+        }
+    } catch (std::exception &ex) {
+        error = ex.what();
+    }
+    done = true;
+}
+
+/**
+ Get the preloaded level if it is the one wanted.
+ Waits for the worker if it isn't done yet, then uploads the decoded images,
+ swaps the level into out and the chunks listed around the start into start_chunks.
+ Returns false if nothing was preloaded for level or the preload failed,
+ in which case the level should be loaded normally.
+ */
+bool LevelPreloader::take(int level, LevelConfig &out, std::vector<Chunk> &start_chunks) {
+    if (this->level < 0) {
+        return false;
+    }
+    if (this->level != level) {
+        cancel();
+        return false;
+    }
+
+    worker.join();
+    if (!error.empty()) {
+        SDL_Log("Preloading level %d failed, loading it normally: %s\n", level, error.c_str());
+        cancel();
+        return false;
+    }
+
+    // textures can only be created on the main thread
+    for (auto &image : images) {
+        ResourceManager::instance().addImage(image.first, image.second);
+    }
+    images.clear();
+
+    out.swap(config);
+    start_chunks.swap(chunks);
+    SDL_Log("Preloaded %s (%dx%d) in %.3f ms\n", filename.c_str(), out.getWidth(), out.getHeight(), load_ms);
+    cancel();
+    return true;
+}
+
+/**
+ Stop waiting on a preload and free whatever it loaded
+ */
+void LevelPreloader::cancel() {
+    if (worker.joinable()) {
+        worker.join();
+    }
+    freeImages();
+    chunks.clear();
+    LevelConfig empty;
+    config.swap(empty);
+    filename.clear();
+    error.clear();
+    level = -1;
+    done = false;
+}
+
+/**
+ Free decoded images that were never uploaded
+ */
+void LevelPreloader::freeImages() {
+    for (auto &image : images) {
+        SDL_FreeSurface(image.second);
+    }
+    images.clear();
+}
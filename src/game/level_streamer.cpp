@@ -0,0 +1,687 @@
+//
+//  Copyright © 2018 Vande Griek, Eric. All rights reserved.
+//
+
+#include "level_streamer.h"
+
+/**
+ Divide rounding towards negative infinity, for positions left of or above the level
+ */
+static int floorDiv(int value, int divisor) {
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+/**
+ Get the range of chunk coordinates that overlap view, grown by margin chunks on each side.
+ Clipped to a level that is chunks_w by chunks_h chunks, so w or h can be 0.
+ */
+static SDL_Rect chunkRangeIn(const SDL_Rect &view, int margin, int chunks_w, int chunks_h) {
+    int cx_start = std::max(0, floorDiv(view.x, CHUNK_SIDE) - margin);
+    int cy_start = std::max(0, floorDiv(view.y, CHUNK_SIDE) - margin);
+    int cx_end = std::min(chunks_w, floorDiv(view.x + view.w, CHUNK_SIDE) + margin + 1);
+    int cy_end = std::min(chunks_h, floorDiv(view.y + view.h, CHUNK_SIDE) + margin + 1);
+    return {cx_start, cy_start, std::max(0, cx_end - cx_start), std::max(0, cy_end - cy_start)};
+}
+
+/**
+ Constructor not used, things are set up in init()
+ */
+LevelStreamer::LevelStreamer() {}
+
+/**
+ Destructor, shutdown() must have been called
+ */
+LevelStreamer::~LevelStreamer() {}
+
+/**
+ Start the worker thread that builds chunks
+ */
+void LevelStreamer::init() {
+    stopping = false;
+    busy = false;
+    worker = std::thread(&LevelStreamer::workerLoop, this);
+}
+
+/**
+ Stop the worker thread.
+ clear() should be called first to free the chunks of the current level.
+ */
+void LevelStreamer::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        stopping = true;
+    }
+    queue_cond.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+
+    // finished chunks that were never picked up
+    for (Chunk *chunk : ready) {
+        deleteChunk(chunk);
+    }
+    ready.clear();
+
+    for (SDL_Texture *texture : spare_textures) {
+        SDL_DestroyTexture(texture);
+    }
+    spare_textures.clear();
+}
+
+/**
+ Begin streaming a level.
+ level_config must stay loaded until clear() is called, and is only changed by reload().
+ spawn_callback creates the being for a tile number at tile coordinates when its chunk is loaded.
+ despawn_callback is given the area of a chunk that moved out of view, beings in it can be removed
+ and will be spawned again the next time the chunk they were placed in is loaded.
+ */
+void LevelStreamer::start(LevelConfig &level_config, std::function<void(int, int, int)> spawn_callback,
+                          std::function<void(const SDL_Rect&)> despawn_callback) {
+    config = &level_config;
+    this->spawn_callback = spawn_callback;
+    this->despawn_callback = despawn_callback;
+
+    chunks_w = (config->getWidth() + CHUNK_TILES - 1) / CHUNK_TILES;
+    chunks_h = (config->getHeight() + CHUNK_TILES - 1) / CHUNK_TILES;
+    chunk_states.assign(chunks_w * chunks_h, ChunkState::CHUNK_UNLOADED);
+
+    // beings stored outside of the grid are spawned with the chunk they start in,
+    // counting sort them by chunk so each chunk's beings are next to each other
+    entity_starts.assign(chunks_w * chunks_h + 1, 0);
+    for (int idx = 0; idx < config->getEntityCount(); ++idx) {
+        LevelEntity entity = config->getEntity(idx);
+        if (entity.type != TileNum::PLAYER && entity.tx < Uint32(config->getWidth())
+            && entity.ty < Uint32(config->getHeight())) {
+            ++entity_starts[(entity.ty / CHUNK_TILES) * chunks_w + (entity.tx / CHUNK_TILES) + 1];
+        }
+    }
+    for (size_t idx = 1; idx < entity_starts.size(); ++idx) {
+        entity_starts[idx] += entity_starts[idx - 1];
+    }
+    chunk_entities.resize(entity_starts.back());
+    std::vector<int> next_slot(entity_starts.begin(), entity_starts.end() - 1);
+    for (int idx = 0; idx < config->getEntityCount(); ++idx) {
+        LevelEntity entity = config->getEntity(idx);
+        if (entity.type != TileNum::PLAYER && entity.tx < Uint32(config->getWidth())
+            && entity.ty < Uint32(config->getHeight())) {
+            int chunk_idx = (entity.ty / CHUNK_TILES) * chunks_w + (entity.tx / CHUNK_TILES);
+            chunk_entities[next_slot[chunk_idx]++] = entity;
+        }
+    }
+
+    resolveTextures(*config);
+}
+
+/**
+ Look up the texture of every tile used in a level up front,
+ the worker thread can't use the resource manager.
+ Nothing is changed if a texture can't be loaded.
+ */
+void LevelStreamer::resolveTextures(const LevelConfig &level_config) {
+    SDL_Texture *textures[UINT8_MAX + 1];
+    for (int tile_num = 0; tile_num <= UINT8_MAX; ++tile_num) {
+        textures[tile_num] = NULL;
+        if (level_config.usesTile(tile_num) && tile_num != TileNum::EMPTY && !isBeingTile(tile_num)) {
+            textures[tile_num] = tileTextureFor(tile_num);
+        }
+    }
+    std::copy(std::begin(textures), std::end(textures), std::begin(tile_textures));
+}
+
+/**
+ Throw away chunks that were requested but not added to the world yet,
+ so they will be requested again.
+ Waits for the worker to finish what it is building.
+ */
+void LevelStreamer::cancelPending() {
+    std::deque<Chunk*> finished;
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        for (auto &request : requests) {
+            setState(request.first, ChunkState::CHUNK_UNLOADED);
+        }
+        requests.clear();
+        idle_cond.wait(lock, [this] { return !busy; });
+        finished.swap(ready);
+    }
+    for (Chunk *chunk : finished) {
+        if (chunk->generation == generation) {
+            setState(chunk->index, ChunkState::CHUNK_UNLOADED);
+        }
+        deleteChunk(chunk);
+    }
+}
+
+/**
+ Replace the running level with a new version of it that has the same size.
+ fresh is swapped with the level config the streamer was started with.
+ Only loaded chunks that have changed tiles are rebuilt.
+ Beings newly placed in chunks that already spawned theirs are created now,
+ other changes to beings apply the next time the level is loaded.
+ */
+void LevelStreamer::reload(LevelConfig &fresh, World &world) {
+    if (config == NULL) {
+        return;
+    }
+    // the worker can't be reading the config or textures while they are replaced
+    cancelPending();
+    // load any new tile images before changing anything
+    resolveTextures(fresh);
+
+    std::vector<Uint8> dirty(chunk_states.size(), 0);
+    std::vector<LevelEntity> new_beings;
+    for (int ty = 0; ty < config->getHeight(); ++ty) {
+        for (int tx = 0; tx < config->getWidth(); ++tx) {
+            int old_num = config->tileAt(tx, ty);
+            int new_num = fresh.tileAt(tx, ty);
+            if (old_num == new_num) {
+                continue;
+            }
+            int index = (ty / CHUNK_TILES) * chunks_w + (tx / CHUNK_TILES);
+            dirty[index] = 1;
+            if (isBeingTile(new_num) && new_num != TileNum::PLAYER
+                && (chunk_states[index] & ChunkState::CHUNK_SPAWNED)) {
+                new_beings.push_back({Uint32(tx), Uint32(ty), Uint8(new_num), {0, 0, 0}});
+            }
+        }
+    }
+    config->swap(fresh);
+
+    std::vector<int> rebuild;
+    std::vector<Chunk*> to_evict;
+    for (int index = 0; index < int(dirty.size()); ++index) {
+        if (!dirty[index]) {
+            continue;
+        }
+        ChunkState state = stateOf(index);
+        if (state == ChunkState::CHUNK_LOADED) {
+            to_evict.push_back(loaded[index]);
+            rebuild.push_back(index);
+        } else if (state == ChunkState::CHUNK_EMPTY) {
+            // may have something in it now
+            setState(index, ChunkState::CHUNK_UNLOADED);
+        }
+    }
+    evict(to_evict, world, false);
+    for (int index : rebuild) {
+        setState(index, ChunkState::CHUNK_PENDING);
+        integrate(buildChunk(index, generation), world);
+    }
+    for (auto &being : new_beings) {
+        spawn_callback(being.type, being.tx, being.ty);
+    }
+}
+
+/**
+ Draw the tiles of every loaded chunk into its texture again,
+ such as after a tile image was reloaded
+ */
+void LevelStreamer::rebake() {
+    for (auto &item : loaded) {
+        bake(item.second);
+    }
+}
+
+/**
+ Unload every chunk and forget the level, removing their tiles from the world.
+ Waits for the worker to finish what it is building so the level config can be replaced.
+ */
+void LevelStreamer::clear(World &world) {
+    std::deque<Chunk*> finished;
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        requests.clear();
+        ++generation;
+        idle_cond.wait(lock, [this] { return !busy; });
+        finished.swap(ready);
+    }
+    for (Chunk *chunk : finished) {
+        deleteChunk(chunk);
+    }
+
+    std::vector<Chunk*> to_evict;
+    for (auto &item : loaded) {
+        to_evict.push_back(item.second);
+    }
+    evict(to_evict, world, false);
+
+    chunk_states.clear();
+    chunk_entities.clear();
+    entity_starts.clear();
+    config = NULL;
+    chunks_w = 0;
+    chunks_h = 0;
+}
+
+/**
+ Build chunks on the worker thread until shutdown
+ */
+void LevelStreamer::workerLoop() {
+    while (true) {
+        std::pair<int, int> job;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_cond.wait(lock, [this] { return stopping || !requests.empty(); });
+            if (stopping) {
+                return;
+            }
+            job = requests.front();
+            requests.pop_front();
+            busy = true;
+        }
+
+        Chunk *chunk = buildChunk(job.first, job.second);
+
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            ready.push_back(chunk);
+            busy = false;
+        }
+        idle_cond.notify_all();
+    }
+}
+
+/**
+ List the tiles of a chunk.
+ Safe to call from the worker thread, only reads the level config.
+ */
+Chunk* LevelStreamer::buildChunk(int index, int chunk_generation) {
+    Chunk *chunk = newChunk();
+    chunk->generation = chunk_generation;
+    listChunk(*config, index, *chunk);
+    return chunk;
+}
+
+/**
+ Fill in the index, area, tiles and beings of chunk number index of a level.
+ Only reads level_config, so it can be called from any thread,
+ such as to build chunks for a level before it is started.
+ */
+void LevelStreamer::listChunk(const LevelConfig &level_config, int index, Chunk &chunk) {
+    int level_chunks_w = (level_config.getWidth() + CHUNK_TILES - 1) / CHUNK_TILES;
+    chunk.index = index;
+    int tx_start = (index % level_chunks_w) * CHUNK_TILES;
+    int ty_start = (index / level_chunks_w) * CHUNK_TILES;
+    int tx_end = std::min(tx_start + CHUNK_TILES, level_config.getWidth());
+    int ty_end = std::min(ty_start + CHUNK_TILES, level_config.getHeight());
+    chunk.rect = {tx_start * TILE_SIDE, ty_start * TILE_SIDE,
+                  (tx_end - tx_start) * TILE_SIDE, (ty_end - ty_start) * TILE_SIDE};
+
+    for (int ty = ty_start; ty < ty_end; ++ty) {
+        for (int tx = tx_start; tx < tx_end; ++tx) {
+            int tile_num = level_config.tileAt(tx, ty);
+            if (tile_num == TileNum::EMPTY || tile_num == TileNum::PLAYER) {
+                // the player is created with the level, not a chunk
+                continue;
+            }
+            if (isBeingTile(tile_num)) {
+                chunk.spawns.push_back({Uint32(tx), Uint32(ty), Uint8(tile_num), {0, 0, 0}});
+                continue;
+            }
+            chunk.tiles.push_back({tx * TILE_SIDE, ty * TILE_SIDE, Uint8(tile_num)});
+        }
+    }
+}
+
+/**
+ Get the index of every chunk of a level that update() loads when view is the area being viewed.
+ Only reads level_config, like listChunk.
+ */
+std::vector<int> LevelStreamer::chunksAround(const LevelConfig &level_config, const SDL_Rect &view) {
+    int level_chunks_w = (level_config.getWidth() + CHUNK_TILES - 1) / CHUNK_TILES;
+    int level_chunks_h = (level_config.getHeight() + CHUNK_TILES - 1) / CHUNK_TILES;
+    SDL_Rect range = chunkRangeIn(view, CHUNK_LOAD_MARGIN, level_chunks_w, level_chunks_h);
+    std::vector<int> indices;
+    for (int cy = range.y; cy < range.y + range.h; ++cy) {
+        for (int cx = range.x; cx < range.x + range.w; ++cx) {
+            indices.push_back(cy * level_chunks_w + cx);
+        }
+    }
+    return indices;
+}
+
+/**
+ Add chunks that were listed ahead of time with listChunk to the world,
+ such as the ones around the start of a level that was preloaded.
+ Their tiles and beings are moved out of chunks.
+ Chunks that are already loaded or requested are skipped.
+ */
+void LevelStreamer::addChunks(std::vector<Chunk> &chunks, World &world) {
+    if (config == NULL) {
+        return;
+    }
+    for (Chunk &listed : chunks) {
+        if (listed.index < 0 || listed.index >= int(chunk_states.size())
+            || stateOf(listed.index) != ChunkState::CHUNK_UNLOADED) {
+            continue;
+        }
+        Chunk *chunk = newChunk();
+        chunk->index = listed.index;
+        chunk->generation = generation;
+        chunk->rect = listed.rect;
+        chunk->tiles.swap(listed.tiles);
+        chunk->spawns.swap(listed.spawns);
+        setState(chunk->index, ChunkState::CHUNK_PENDING);
+        integrate(chunk, world);
+    }
+}
+
+/**
+ Add a finished chunk to the world.
+ Spawns its beings unless they already are, creates an entity for each tile
+ and bakes the tiles into one texture.
+ */
+void LevelStreamer::integrate(Chunk *chunk, World &world) {
+    if (chunk->generation != generation) {
+        // built for a level that has since been unloaded
+        deleteChunk(chunk);
+        return;
+    }
+
+    int index = chunk->index;
+    if (!(chunk_states[index] & ChunkState::CHUNK_SPAWNED)) {
+        chunk_states[index] |= ChunkState::CHUNK_SPAWNED;
+        for (auto &spawn : chunk->spawns) {
+            spawn_callback(spawn.type, spawn.tx, spawn.ty);
+        }
+        for (int idx = entity_starts[index]; idx < entity_starts[index + 1]; ++idx) {
+            LevelEntity &entity = chunk_entities[idx];
+            spawn_callback(entity.type, entity.tx, entity.ty);
+        }
+    }
+
+    if (chunk->tiles.empty() && chunk->spawns.empty() && entity_starts[index] == entity_starts[index + 1]) {
+        // nothing to keep, remember that it is empty so it is never loaded again
+        setState(index, ChunkState::CHUNK_EMPTY);
+        deleteChunk(chunk);
+        return;
+    }
+
+    chunk->entities.reserve(chunk->tiles.size());
+    for (auto &tile : chunk->tiles) {
+        chunk->entities.push_back(world.createTile(tile.tile_num, tile.x_pos, tile.y_pos));
+    }
+    bake(chunk);
+    loaded[index] = chunk;
+    setState(index, ChunkState::CHUNK_LOADED);
+}
+
+/**
+ Draw every tile of a chunk into a single texture so it can be drawn with one copy.
+ The texture is made at the resolution the world is drawn at, or reused if the chunk has one.
+ Full size chunks take a spare texture left by an unloaded chunk before making a new one.
+ If it can't be made the tiles are drawn one by one.
+ Chunks that only have beings in them have nothing to bake.
+ */
+void LevelStreamer::bake(Chunk *chunk) {
+    if (chunk->tiles.empty()) {
+        return;
+    }
+    SDL_Renderer *renderer = Graphics::instance().getRenderer();
+    int divisor = Graphics::instance().getWorldDivisor();
+    bool full_size = chunk->rect.w == CHUNK_SIDE && chunk->rect.h == CHUNK_SIDE;
+    if (chunk->texture == NULL && full_size && !spare_textures.empty()) {
+        chunk->texture = spare_textures.back();
+        spare_textures.pop_back();
+    }
+    if (chunk->texture == NULL) {
+        chunk->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+                                           chunk->rect.w / divisor, chunk->rect.h / divisor);
+    }
+    if (chunk->texture == NULL) {
+        SDL_Log("Failed to bake chunk %d: %s\n", chunk->index, SDL_GetError());
+        return;
+    }
+    SDL_SetTextureBlendMode(chunk->texture, SDL_BLENDMODE_BLEND);
+
+    SDL_Texture *prev_target = SDL_GetRenderTarget(renderer);
+    SDL_SetRenderTarget(renderer, chunk->texture);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+    for (auto &tile : chunk->tiles) {
+        SDL_Rect dest = {(tile.x_pos - chunk->rect.x) / divisor, (tile.y_pos - chunk->rect.y) / divisor,
+                         TILE_SIDE / divisor, TILE_SIDE / divisor};
+        SDL_RenderCopy(renderer, tile_textures[tile.tile_num], NULL, &dest);
+    }
+    SDL_SetRenderTarget(renderer, prev_target);
+}
+
+/**
+ Unload chunks, removing their tiles from the world.
+ If despawn is true the beings in them are handed to despawn_callback too,
+ and the beings placed in them are spawned again when they are loaded again.
+ */
+void LevelStreamer::evict(const std::vector<Chunk*> &chunks, World &world, bool despawn) {
+    for (Chunk *chunk : chunks) {
+        for (EntityId entity : chunk->entities) {
+            world.remove(entity);
+        }
+        if (despawn) {
+            chunk_states[chunk->index] &= Uint8(~ChunkState::CHUNK_SPAWNED);
+            despawn_callback(chunk->rect);
+        }
+        loaded.erase(chunk->index);
+        if (!chunk_states.empty()) {
+            setState(chunk->index, ChunkState::CHUNK_UNLOADED);
+        }
+        deleteChunk(chunk);
+    }
+}
+
+/**
+ Get an empty chunk from the pool.
+ Safe to call from the worker thread.
+ */
+Chunk* LevelStreamer::newChunk() {
+    Chunk *chunk;
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex);
+        chunk = chunk_pool.acquire();
+    }
+    chunk->tiles.clear();
+    chunk->tiles.reserve(CHUNK_TILES * CHUNK_TILES);
+    chunk->entities.clear();
+    chunk->spawns.clear();
+    return chunk;
+}
+
+/**
+ Give a chunk back to the pool.
+ Its texture is kept to bake another chunk into if it is full size and there is room,
+ otherwise it is freed.
+ */
+void LevelStreamer::deleteChunk(Chunk *chunk) {
+    if (chunk->texture != NULL) {
+        if (chunk->rect.w == CHUNK_SIDE && chunk->rect.h == CHUNK_SIDE
+            && spare_textures.size() < CHUNK_SPARE_TEXTURES) {
+            spare_textures.push_back(chunk->texture);
+        } else {
+            SDL_DestroyTexture(chunk->texture);
+        }
+        chunk->texture = NULL;
+    }
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    chunk_pool.release(chunk);
+}
+
+/**
+ Get the range of chunk coordinates that overlap view, grown by margin chunks on each side.
+ Clipped to the level, so w or h can be 0.
+ */
+SDL_Rect LevelStreamer::chunkRange(const SDL_Rect &view, int margin) {
+    return chunkRangeIn(view, margin, chunks_w, chunks_h);
+}
+
+/**
+ Stream chunks in and out based on the area of the world being viewed.
+ Chunks the worker has finished are added to the world, new ones near the view are requested,
+ and ones far from the view are removed from the world and freed.
+ If blocking is true, missing chunks near the view are built right away instead.
+ */
+void LevelStreamer::update(const SDL_Rect &view, World &world, bool blocking) {
+    if (config == NULL) {
+        return;
+    }
+
+    // pick up whatever the worker has finished
+    std::deque<Chunk*> finished;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        finished.swap(ready);
+    }
+    for (Chunk *chunk : finished) {
+        integrate(chunk, world);
+    }
+
+    // drop requests the view has moved away from before the worker gets to them
+    SDL_Rect keep = chunkRange(view, CHUNK_EVICT_MARGIN);
+    auto out_of_range = [this, &keep](int index) {
+        int cx = index % chunks_w;
+        int cy = index / chunks_w;
+        return cx < keep.x || cx >= keep.x + keep.w || cy < keep.y || cy >= keep.y + keep.h;
+    };
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        for (auto it = requests.begin(); it != requests.end();) {
+            if (out_of_range(it->first)) {
+                setState(it->first, ChunkState::CHUNK_UNLOADED);
+                it = requests.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // request missing chunks near the view, closest first
+    SDL_Rect wanted = chunkRange(view, CHUNK_LOAD_MARGIN);
+    int center_cx = floorDiv(view.x + view.w / 2, CHUNK_SIDE);
+    int center_cy = floorDiv(view.y + view.h / 2, CHUNK_SIDE);
+    std::vector<std::pair<int, int>> missing; // distance and index
+    for (int cy = wanted.y; cy < wanted.y + wanted.h; ++cy) {
+        for (int cx = wanted.x; cx < wanted.x + wanted.w; ++cx) {
+            int index = cy * chunks_w + cx;
+            if (stateOf(index) == ChunkState::CHUNK_UNLOADED) {
+                int dist = std::abs(cx - center_cx) + std::abs(cy - center_cy);
+                missing.push_back({dist, index});
+            }
+        }
+    }
+    std::sort(missing.begin(), missing.end());
+    for (auto &item : missing) {
+        setState(item.second, ChunkState::CHUNK_PENDING);
+        if (blocking) {
+            integrate(buildChunk(item.second, generation), world);
+        }
+    }
+    if (!blocking && !missing.empty()) {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            for (auto &item : missing) {
+                requests.push_back({item.second, generation});
+            }
+        }
+        queue_cond.notify_one();
+    }
+
+    // unload chunks that are well out of view
+    std::vector<Chunk*> to_evict;
+    for (auto &item : loaded) {
+        if (out_of_range(item.first)) {
+            to_evict.push_back(item.second);
+        }
+    }
+    evict(to_evict, world, true);
+}
+
+/**
+ Draw the baked texture of every loaded chunk that is in view.
+ Chunks that couldn't be baked have their tiles drawn one by one.
+ */
+void LevelStreamer::render() {
+    SDL_Renderer *renderer = Graphics::instance().getRenderer();
+    SDL_Rect view = Graphics::instance().getViewRect();
+    for (auto &item : loaded) {
+        Chunk *chunk = item.second;
+        if (!SDL_HasIntersection(&chunk->rect, &view)) {
+            continue;
+        }
+        if (chunk->texture == NULL) {
+            for (auto &tile : chunk->tiles) {
+                SDL_Rect dest = {tile.x_pos - view.x, tile.y_pos - view.y, TILE_SIDE, TILE_SIDE};
+                SDL_RenderCopy(renderer, tile_textures[tile.tile_num], NULL, &dest);
+            }
+            continue;
+        }
+        SDL_Rect dest = {chunk->rect.x - view.x, chunk->rect.y - view.y, chunk->rect.w, chunk->rect.h};
+        SDL_RenderCopy(renderer, chunk->texture, NULL, &dest);
+    }
+}
+
+/**
+ True if every chunk around rect is loaded or known to be empty,
+ so something there can move without falling through unloaded ground.
+ */
+bool LevelStreamer::isSettled(const SDL_Rect &rect) {
+    if (config == NULL) {
+        return true;
+    }
+    SDL_Rect range = chunkRange(rect, 1);
+    for (int cy = range.y; cy < range.y + range.h; ++cy) {
+        for (int cx = range.x; cx < range.x + range.w; ++cx) {
+            ChunkState state = stateOf(cy * chunks_w + cx);
+            if (state != ChunkState::CHUNK_LOADED && state != ChunkState::CHUNK_EMPTY) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ True if the chunk a world position is in has been added to the world
+ */
+bool LevelStreamer::isChunkLoaded(int x_pos, int y_pos) {
+    if (config == NULL || x_pos < 0 || y_pos < 0) {
+        return false;
+    }
+    int cx = x_pos / CHUNK_SIDE;
+    int cy = y_pos / CHUNK_SIDE;
+    return cx < chunks_w && cy < chunks_h && stateOf(cy * chunks_w + cx) == ChunkState::CHUNK_LOADED;
+}
+
+/**
+ Estimate the memory used by baked chunk textures, at 4 bytes a pixel
+ */
+size_t LevelStreamer::bakedBytes() {
+    size_t bytes = 0;
+    for (auto &item : loaded) {
+        if (item.second->texture != NULL) {
+            int width = 0, height = 0;
+            SDL_QueryTexture(item.second->texture, NULL, NULL, &width, &height);
+            bytes += size_t(width) * height * 4;
+        }
+    }
+    return bytes;
+}
+
+/**
+ Get the number of chunks the pool has allocated, in use or not
+ */
+size_t LevelStreamer::pooledCount() {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    return chunk_pool.capacity();
+}
+
+/**
+ Get the most tiles that can be loaded at once while view is in the level,
+ if every chunk kept around it were full
+ */
+int LevelStreamer::maxLoadedTiles(const SDL_Rect &view) {
+    if (config == NULL) {
+        return 0;
+    }
+    // a view overlaps at most one more chunk than fits in it on each axis
+    int chunks = std::min(view.w / CHUNK_SIDE + 2 + 2 * CHUNK_EVICT_MARGIN, chunks_w)
+                 * std::min(view.h / CHUNK_SIDE + 2 + 2 * CHUNK_EVICT_MARGIN, chunks_h);
+    return std::min(chunks * CHUNK_TILES * CHUNK_TILES, config->getWidth() * config->getHeight());
+}
@@ -0,0 +1,605 @@
+//
+//  Copyright © 2018 Vande Griek, Eric. All rights reserved.
+//
+
+#include "systems.h"
+
+/**
+ Return true if the being is currently considered on the ground
+ */
+static bool isOnGround(const Locomotion &loco, Uint32 now) {
+    unsigned int diff = now - loco.last_grounded;
+    return diff <= JUMP_TOLERANCE_MS;
+}
+
+/**
+ Play a sound coming from the center of an entity
+ */
+static void playSoundFrom(World &world, EntityId entity, SoundId sound,
+                          SoundPriority priority = SoundPriority::NORMAL) {
+    const SDL_Rect &box = world.colliders.get(entity).box;
+    Audio::instance().playSoundAt(sound, box.x + box.w / 2, box.y + box.h / 2, priority);
+}
+
+/**
+ Mark a being for removal and play its death sound
+ */
+static void destroyBeing(World &world, EntityId entity) {
+    world.destroy(entity);
+    playSoundFrom(world, entity, world.types.get(entity)->damaged_sound);
+}
+
+/**
+ Apply damage to a being
+ */
+static void takeDamage(World &world, EntityId entity, int amount) {
+    if (amount <= 0) {
+        return;
+    }
+    Health &health = world.health.get(entity);
+    health.hp -= amount;
+    playSoundFrom(world, entity, world.types.get(entity)->damaged_sound);
+
+    const SDL_Rect &box = world.colliders.get(entity).box;
+    float center_x = box.x + box.w / 2;
+    float center_y = box.y + box.h / 2;
+    if (health.hp <= 0) {
+        Particles::instance().emit(ParticleEffect::DEATH_BURST, center_x, center_y, DEATH_BURST_PARTICLES);
+    } else {
+        Particles::instance().emit(ParticleEffect::DAMAGE_SPARKS, center_x, center_y, DAMAGE_SPARK_PARTICLES);
+    }
+}
+
+/**
+ Get the damage an entity does when it hits something
+ */
+static int damageOf(World &world, EntityId entity) {
+    Damage *damage = world.damage.find(entity);
+    return damage != NULL ? damage->amount : 0;
+}
+
+/**
+ Called when entity hits other, beings bounce off of bouncy things
+ */
+static void hitOther(World &world, EntityId entity, EntityId other) {
+    if (world.locomotion.has(entity) && (world.colliders.get(other).flags & COLLIDER_BOUNCY)) {
+        world.kinematics.get(entity).y_vel = -JUMP_VELOCITY;
+        playSoundFrom(world, entity, world.types.get(entity)->jump_sound);
+    }
+}
+
+/**
+ Called when entity is hit by other
+ */
+static void hitBy(World &world, EntityId entity, EntityId other) {
+    if (world.health.has(entity)) {
+        takeDamage(world, entity, damageOf(world, other));
+    }
+}
+
+/**
+ Called when entity bumps into other
+ */
+static void ranInto(World &world, EntityId entity, EntityId other) {
+    if (world.health.has(entity) && !world.types.get(entity)->bump_immune) {
+        takeDamage(world, entity, damageOf(world, other));
+    }
+}
+
+/**
+ Called when top comes down on bottom.
+ The one on top hurts the other and bounces off, unless the one on the bottom hits back.
+ */
+static void hopOn(World &world, EntityId top, EntityId bottom) {
+    if (world.colliders.get(bottom).flags & COLLIDER_HIT_BACK) {
+        // bottom damages top (spikes, etc)
+        hitBy(world, top, bottom);
+        hitOther(world, bottom, top);
+    } else {
+        // top damages bottom
+        hitOther(world, top, bottom);
+        hitBy(world, bottom, top);
+    }
+}
+
+/**
+ Called when a being touches down after being in the air
+ */
+static void landed(World &world, EntityId entity) {
+    playSoundFrom(world, entity, world.types.get(entity)->landed_sound);
+    const SDL_Rect &box = world.colliders.get(entity).box;
+    Particles::instance().emit(ParticleEffect::LANDING_DUST, box.x + box.w / 2, box.y + box.h,
+                               LANDING_DUST_PARTICLES);
+}
+
+/**
+ Stop mover after running into other and queue what the collision does.
+ Only one of x_off or y_off will be filled in.
+ Nothing but the mover changes until the events are handled by updateCollisions.
+ */
+static void resolveCollision(World &world, EntityId mover, EntityId other, float x_off, float y_off, Uint32 now) {
+    // stop our momentum
+    Kinematics &kin = world.kinematics.get(mover);
+    if (x_off != 0) {
+        kin.x_vel = 0;
+    }
+    if (y_off != 0) {
+        kin.y_vel = 0;
+    }
+
+    Uint8 mover_flags = world.colliders.get(mover).flags;
+    Uint8 other_flags = world.colliders.get(other).flags;
+    if (mover_flags & COLLIDER_GOAL) {
+        world.collisions.push_back({CollisionEventType::GOAL, other, NO_ENTITY});
+    }
+    if (other_flags & COLLIDER_GOAL) {
+        world.collisions.push_back({CollisionEventType::GOAL, mover, NO_ENTITY});
+    }
+
+    if (y_off > 0) {
+        // we jumped on other
+        world.collisions.push_back({CollisionEventType::HOP, mover, other});
+    } else if (y_off < 0) {
+        // we jumped into other's feet
+        world.collisions.push_back({CollisionEventType::HOP, other, mover});
+    } else if (x_off != 0) {
+        // we ran into each other
+        world.collisions.push_back({CollisionEventType::BUMP, mover, other});
+    }
+
+    Locomotion *loco = world.locomotion.find(mover);
+    if (loco != NULL && y_off > 0) {
+        // we have collided while moving down,
+        // so we have landed on something
+        if (!isOnGround(*loco, now)) {
+            world.collisions.push_back({CollisionEventType::LAND, mover, NO_ENTITY});
+        }
+        loco->last_grounded = now;
+        loco->jump_start_ts = 0; // zero means not jumping
+        loco->air_jumps = world.types.get(mover)->max_air_jumps;
+    }
+}
+
+/**
+ Move an entity up to x_offset and y_offset, stopping at the first thing it runs into on each axis
+ */
+static void moveEntity(World &world, EntityId mover, float x_offset, float y_offset, Uint32 now) {
+    SDL_Rect &box = world.colliders.get(mover).box;
+    SDL_Rect new_rect = {int(box.x + x_offset), int(box.y + y_offset), box.w, box.h};
+
+    std::priority_queue<CollisionRecord> collisions;
+    for (int idx = 0; idx < world.colliders.size(); ++idx) {
+        EntityId other = world.colliders.ownerAt(idx);
+        const SDL_Rect &other_box = world.colliders.at(idx).box;
+        if (other == mover || !SDL_HasIntersection(&new_rect, &other_box)) {
+            continue;
+        }
+        if (x_offset > 0) {
+            // find the distance to the other entity on this axis
+            float x_diff = other_box.x - (box.x + box.w);
+            if (x_diff >= 0) {
+                // save a record of this collision
+                collisions.push({Axis::X, x_diff / x_offset, x_diff, other});
+            } // else: a negative value means we aren't going to intersect in this axis
+        } else if (x_offset < 0) {
+            float x_diff = (other_box.x + other_box.w) - box.x;
+            if (x_diff <= 0) {
+                collisions.push({Axis::X, x_diff / x_offset, x_diff, other});
+            }
+        }
+
+        // y axis
+        if (y_offset > 0) {
+            float y_diff = other_box.y - (box.y + box.h);
+            if (y_diff >= 0) {
+                collisions.push({Axis::Y, y_diff / y_offset, y_diff, other});
+            }
+        } else if (y_offset < 0) {
+            float y_diff = (other_box.y + other_box.h) - box.y;
+            if (y_diff <= 0) {
+                collisions.push({Axis::Y, y_diff / y_offset, y_diff, other});
+            }
+        }
+    }
+
+    // the other entity that was collided with in each axis
+    EntityId collision_other_x = NO_ENTITY;
+    EntityId collision_other_y = NO_ENTITY;
+    while (!collisions.empty()) {
+        CollisionRecord record = collisions.top();
+        collisions.pop();
+        const SDL_Rect &other_box = world.colliders.get(record.other).box;
+        if (record.axis == Axis::X) {
+            if (collision_other_x == NO_ENTITY && SDL_HasIntersection(&new_rect, &other_box)) {
+                new_rect.x = box.x + record.diff;
+                collision_other_x = record.other;
+            }
+        } else { // y
+            if (collision_other_y == NO_ENTITY && SDL_HasIntersection(&new_rect, &other_box)) {
+                new_rect.y = box.y + record.diff;
+                collision_other_y = record.other;
+            }
+        }
+        if (collision_other_x != NO_ENTITY && collision_other_y != NO_ENTITY) {
+            // the earliest collisions have been handled for both x and y
+            // we can stop now
+            break;
+        }
+    }
+
+    // update position to as far as we could go
+    box.x = new_rect.x;
+    box.y = new_rect.y;
+
+    if (collision_other_x != NO_ENTITY) {
+        resolveCollision(world, mover, collision_other_x, x_offset, 0, now);
+    }
+    if (collision_other_y != NO_ENTITY) {
+        resolveCollision(world, mover, collision_other_y, 0, y_offset, now);
+    }
+}
+
+/**
+ Adjust the velocity of a being for gravity, jumping and walking
+ */
+static void applyLocomotion(World &world, EntityId entity, Kinematics &kin, Locomotion &loco,
+                            const BeingType &type, int delta, Uint32 now) {
+    // apply gravity
+    kin.y_vel += GRAVITY * delta;
+
+    // limit max fall velocity
+    if (kin.y_vel > TERMINAL_VELOCITY) {
+        kin.y_vel = TERMINAL_VELOCITY;
+    }
+
+    // vertical movement / jump
+    if (loco.jump_start_ts != 0 && now - loco.jump_start_ts <= type.jump_duration) {
+        kin.y_vel = -JUMP_VELOCITY;
+    }
+
+    // horizonal movement
+    if (loco.target_x_vel > 0 && kin.x_vel < type.top_speed) {
+        // moving right
+        // apply additional accel if we are at negative velocity
+        float accel = MOVE_ACCEL;
+        if (kin.x_vel < 0) {
+            accel += CORRECTION_ACCEL;
+        }
+        kin.x_vel += accel * delta;
+        if (kin.x_vel > type.top_speed) {
+            kin.x_vel = type.top_speed;
+        }
+    } else if (loco.target_x_vel < 0 && kin.x_vel > -type.top_speed) {
+        // moving left
+        // apply additional accel if we are at positive velocity
+        float accel = MOVE_ACCEL;
+        if (kin.x_vel > 0) {
+            accel += CORRECTION_ACCEL;
+        }
+        kin.x_vel -= accel * delta;
+        if (kin.x_vel < -type.top_speed) {
+            kin.x_vel = -type.top_speed;
+        }
+    } else if (loco.target_x_vel == 0.0f && isOnGround(loco, now)) {
+        // stopping
+        // slow to zero unless we are in the air
+        if (kin.x_vel > 0) {
+            kin.x_vel = std::max(0.0f, kin.x_vel - FRICTION * delta);
+        } else if (kin.x_vel < 0) {
+            kin.x_vel = std::min(0.0f, kin.x_vel + FRICTION * delta);
+        }
+    }
+
+    // play sounds
+    if (loco.target_x_vel != 0 && isOnGround(loco, now)) {
+        SoundId walk_sound = type.walk_sound;
+        Uint32 played_ago = now - Audio::instance().getLastPlayed(walk_sound);
+        if (played_ago > WALK_SOUND_INTERVAL_MS) {
+            playSoundFrom(world, entity, walk_sound, SoundPriority::AMBIENT);
+        }
+    }
+}
+
+/**
+ Freeze everything that moves while the ground around it is still loading,
+ so it doesn't fall through
+ */
+void updateFrozen(World &world, LevelStreamer &streamer) {
+    for (int idx = 0; idx < world.kinematics.size(); ++idx) {
+        EntityId entity = world.kinematics.ownerAt(idx);
+        world.kinematics.at(idx).frozen = !streamer.isSettled(world.colliders.get(entity).box);
+    }
+}
+
+/**
+ Update every enemy based on its action type.
+ Enemies draw from their own random numbers, so the order they are updated in doesn't change what they do.
+ Only enemies whose index is slice modulo slices are updated, so the work can be spread over several ticks.
+ */
+void updateAi(World &world, int slice, int slices) {
+    Uint32 now = SDL_GetTicks();
+    for (int idx = 0; idx < world.ai.size(); ++idx) {
+        EntityId entity = world.ai.ownerAt(idx);
+        // split by index rather than position in the array, removing entities reorders the array
+        if (entityIndex(entity) % slices != Uint32(slice)) {
+            continue;
+        }
+        if (world.kinematics.get(entity).frozen || isDead(world, entity)) {
+            continue;
+        }
+        Ai &ai = world.ai.at(idx);
+        Locomotion &loco = world.locomotion.get(entity);
+        const BeingType &type = *world.types.get(entity);
+        int action_len = now - ai.action_start_ts;
+        if (type.action_type == ActionType::CHARGE) {
+            // run in a direction for 1 second
+            if (action_len > 1000) {
+                int dir = ai.rng.range(0, 2);
+                switch(dir) {
+                    case 0:
+                        // stand still
+                        loco.target_x_vel = 0;
+                        break;
+                    case 1:
+                        // run right
+                        loco.target_x_vel = type.top_speed;
+                        break;
+                    case 2:
+                        // run left
+                        loco.target_x_vel = -type.top_speed;
+                        break;
+                }
+                ai.action_start_ts = now;
+            }
+        } else if (type.action_type == ActionType::JUMP_AROUND) {
+            // jump in a direction
+            if (isOnGround(loco, now) && action_len > 500) {
+                int dir = ai.rng.range(0, 2);
+                switch(dir) {
+                    case 0:
+                        // stand still
+                        loco.target_x_vel = 0;
+                        break;
+                    case 1:
+                        // run right
+                        loco.target_x_vel = type.top_speed;
+                        jumpBeing(world, entity);
+                        break;
+                    case 2:
+                        // run left
+                        loco.target_x_vel = -type.top_speed;
+                        jumpBeing(world, entity);
+                        break;
+                }
+                ai.action_start_ts = now;
+            }
+        }
+    }
+}
+
+/**
+ Accelerate and move everything that moves, handling what it runs into.
+ delta is in ms.
+ */
+void updatePhysics(World &world, int delta) {
+    Uint32 now = SDL_GetTicks();
+    for (int idx = 0; idx < world.kinematics.size(); ++idx) {
+        EntityId entity = world.kinematics.ownerAt(idx);
+        Kinematics &kin = world.kinematics.at(idx);
+        if (kin.frozen || isDead(world, entity)) {
+            continue;
+        }
+        Locomotion *loco = world.locomotion.find(entity);
+        if (loco != NULL) {
+            applyLocomotion(world, entity, kin, *loco, *world.types.get(entity), delta, now);
+        }
+        moveEntity(world, entity, kin.x_vel * delta, kin.y_vel * delta, now);
+    }
+}
+
+/**
+ Handle the collisions from this tick's movement in the order they happened.
+ Run after updatePhysics, so what collisions do never changes things that are still moving.
+ */
+void updateCollisions(World &world) {
+    for (const CollisionEvent &event : world.collisions) {
+        switch (event.type) {
+            case CollisionEventType::HOP:
+                hopOn(world, event.entity, event.other);
+                break;
+            case CollisionEventType::BUMP:
+                ranInto(world, event.entity, event.other);
+                ranInto(world, event.other, event.entity);
+                break;
+            case CollisionEventType::LAND:
+                landed(world, event.entity);
+                break;
+            case CollisionEventType::GOAL:
+                world.hitGoal(event.entity);
+                break;
+        }
+    }
+    world.collisions.clear();
+}
+
+/**
+ Destroy beings that have been dead long enough or have fallen below lower_bound
+ */
+void updateLifetimes(World &world, int lower_bound) {
+    Uint32 now = SDL_GetTicks();
+    for (int idx = 0; idx < world.health.size(); ++idx) {
+        EntityId entity = world.health.ownerAt(idx);
+        Kinematics *kin = world.kinematics.find(entity);
+        Health &health = world.health.at(idx);
+        if ((kin != NULL && kin->frozen) || health.hp > 0) {
+            continue;
+        }
+        if (health.destroy_at_ts == 0) {
+            health.destroy_at_ts = now + BEING_DEATH_DELAY_MS;
+        } else if (now >= health.destroy_at_ts) {
+            destroyBeing(world, entity);
+        }
+    }
+
+    for (int idx = 0; idx < world.kinematics.size(); ++idx) {
+        EntityId entity = world.kinematics.ownerAt(idx);
+        if (!world.kinematics.at(idx).frozen && world.colliders.get(entity).box.y > lower_bound) {
+            destroyBeing(world, entity);
+        }
+    }
+}
+
+/**
+ Update the state of each being's sprite based on what the being is doing
+ */
+void updateSprites(World &world) {
+    Uint32 now = SDL_GetTicks();
+    for (int idx = 0; idx < world.sprites.size(); ++idx) {
+        EntityId entity = world.sprites.ownerAt(idx);
+        Kinematics &kin = world.kinematics.get(entity);
+        if (kin.frozen) {
+            continue;
+        }
+        Sprite &sprite = world.sprites.at(idx).sprite;
+        Locomotion &loco = world.locomotion.get(entity);
+        if (isDead(world, entity)) {
+            sprite.setDead();
+        } else if (!isOnGround(loco, now)) {
+            sprite.setJumping();
+        } else if (kin.x_vel == 0.0f) {
+            sprite.setIdle();
+        } else if (loco.target_x_vel != 0.0f) {
+            sprite.setWalking();
+        } else {
+            sprite.setBraking();
+        }
+        sprite.update();
+    }
+}
+
+/**
+ Give off embers from fire tiles that are on screen.
+ delta is in ms.
+ */
+void updateEmitters(World &world, int delta) {
+    int screen_off_x, screen_off_y;
+    std::tie(screen_off_x, screen_off_y) = Graphics::instance().getScreenOffsets();
+    int screen_w = Graphics::instance().getWindowWidth();
+    int screen_h = Graphics::instance().getWindowHeight();
+    for (int idx = 0; idx < world.emitters.size(); ++idx) {
+        EmberEmitter &emitter = world.emitters.at(idx);
+        emitter.ember_timer -= delta;
+        if (emitter.ember_timer > 0) {
+            continue;
+        }
+        emitter.ember_timer = EMBER_INTERVAL_MS;
+        const SDL_Rect &box = world.colliders.get(world.emitters.ownerAt(idx)).box;
+        if (box.x + box.w >= screen_off_x && box.x <= screen_off_x + screen_w
+            && box.y + box.h >= screen_off_y && box.y <= screen_off_y + screen_h) {
+            // start somewhere along the top edge
+            Particles::instance().emit(ParticleEffect::EMBERS, box.x + box.w / 2, box.y, 1, box.w);
+        }
+    }
+}
+
+/**
+ Draw every being that has a sprite
+ */
+void renderSprites(World &world) {
+    int screen_off_x, screen_off_y;
+    std::tie(screen_off_x, screen_off_y) = Graphics::instance().getScreenOffsets();
+    SDL_Renderer *renderer = Graphics::instance().getRenderer();
+    ResourceManager &resources = ResourceManager::instance();
+    for (int idx = 0; idx < world.sprites.size(); ++idx) {
+        EntityId entity = world.sprites.ownerAt(idx);
+        SpriteView &view = world.sprites.at(idx);
+        const BeingType &type = *world.types.get(entity);
+        const SDL_Rect &box = world.colliders.get(entity).box;
+        SDL_Texture *sheet = resources.getLoadedImage(type.sprite_sheet);
+        if (sheet == NULL) {
+            // the sprite sheet is still loading in the background, or failed to load
+            SDL_Rect placeholder_rect = {box.x - screen_off_x, box.y - screen_off_y, box.w, box.h};
+            SDL_RenderCopy(renderer, resources.getPlaceholderImage(), NULL, &placeholder_rect);
+            continue;
+        }
+        SDL_Rect rend_rect = {box.x - screen_off_x - type.pad_left, box.y - screen_off_y - type.pad_top,
+                              box.w + type.pad_left + type.pad_right, box.h + type.pad_top + type.pad_bot};
+        SDL_RendererFlip flip_mode = view.facing == Facing::RIGHT ? SDL_FLIP_NONE : SDL_FLIP_HORIZONTAL;
+        SDL_RenderCopyEx(renderer, sheet, &view.sprite.getFrameRect(), &rend_rect, 0, NULL, flip_mode);
+    }
+}
+
+/**
+ True if the entity can be hurt and has died
+ */
+bool isDead(World &world, EntityId entity) {
+    Health *health = world.health.find(entity);
+    return health != NULL && health->hp <= 0;
+}
+
+/**
+ Make a being jump if it is allowed to
+ */
+void jumpBeing(World &world, EntityId entity) {
+    Locomotion *loco = world.locomotion.find(entity);
+    if (loco == NULL) {
+        return;
+    }
+    Uint32 now = SDL_GetTicks();
+    bool on_ground = isOnGround(*loco, now);
+    if (on_ground || loco->air_jumps > 0) {
+        loco->jump_start_ts = now;
+        if (!on_ground) {
+            --loco->air_jumps;
+        }
+        playSoundFrom(world, entity, world.types.get(entity)->jump_sound);
+    }
+}
+
+/**
+ Set a being to try to move to the right.
+ Goes until stopBeingRight is called.
+ */
+void moveBeingRight(World &world, EntityId entity) {
+    Locomotion *loco = world.locomotion.find(entity);
+    if (loco != NULL) {
+        float top_speed = world.types.get(entity)->top_speed;
+        loco->target_x_vel = std::min(top_speed, loco->target_x_vel + top_speed);
+        world.sprites.get(entity).facing = Facing::RIGHT;
+    }
+}
+
+/**
+ Begin to stop a being moving to the right
+ */
+void stopBeingRight(World &world, EntityId entity) {
+    Locomotion *loco = world.locomotion.find(entity);
+    if (loco != NULL) {
+        float top_speed = world.types.get(entity)->top_speed;
+        loco->target_x_vel = std::max(0.0f, loco->target_x_vel - top_speed);
+    }
+}
+
+/**
+ Set a being to try to move to the left.
+ Goes until stopBeingLeft is called.
+ */
+void moveBeingLeft(World &world, EntityId entity) {
+    Locomotion *loco = world.locomotion.find(entity);
+    if (loco != NULL) {
+        float top_speed = world.types.get(entity)->top_speed;
+        loco->target_x_vel = std::max(-top_speed, loco->target_x_vel - top_speed);
+        world.sprites.get(entity).facing = Facing::LEFT;
+    }
+}
+
+/**
+ Begin to stop a being moving to the left
+ */
+void stopBeingLeft(World &world, EntityId entity) {
+    Locomotion *loco = world.locomotion.find(entity);
+    if (loco != NULL) {
+        float top_speed = world.types.get(entity)->top_speed;
+        loco->target_x_vel = std::min(0.0f, loco->target_x_vel + top_speed);
+    }
+}
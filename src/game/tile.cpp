@@ -3,43 +3,25 @@
 //  Copyright © 2018 Vande Griek, Eric. All rights reserved.
 //
 
-#include <stdio.h>
 #include "tile.h"
 
 /**
- Create a new tile that corresponds to tile_num
+ Get the name of the image used for a tile number
  */
-Tile::Tile(int tile_num) {
-    // choose texture based on tile_num
-    std::string tile_texture = TEXTURE_PREFIX + std::to_string(tile_num) + TEXTURE_SUFFIX;
-    texture = ResourceManager::instance().getImageTexture(tile_texture);
-
-    rect.setColliderSize(TILE_SIDE, TILE_SIDE);
-
-    // do things based on tile type
-    if (tile_num == TileNum::DAMAGE) {
-        damage = DAMAGE_TILE_DAMAGE;
-        hit_back_when_hopped_on = true;
-        bouncy = true;
-    }
-}
-
-/**
- Update the object based on how much time has passed.
- delta is in ms.
- */
-void Tile::update(int delta, std::vector<Drawable*> &objects) {
-    // tiles don't do anything
+std::string tileTextureName(int tile_num) {
+    return TEXTURE_PREFIX + std::to_string(tile_num) + TEXTURE_SUFFIX;
 }
 
 /**
- Draw the tile onto the screen
+ Get the texture for a tile number.
+ Looked up once up front so tiles can be created off the main thread.
+ The image name is only built the first time each tile number is used.
  */
-void Tile::render() {
-    int screen_off_x, screen_off_y;
-    std::tie(screen_off_x, screen_off_y) = Graphics::instance().getScreenOffsets();
-    SDL_Rect rend_rect;
-    rect.fillRenderRect(rend_rect, screen_off_x, screen_off_y);
-    SDL_Renderer *renderer = Graphics::instance().getRenderer();
-    SDL_RenderCopy(renderer, texture, NULL, &rend_rect);
+SDL_Texture* tileTextureFor(int tile_num) {
+    static std::vector<ImageId> image_ids(UINT8_MAX + 1, NO_IMAGE);
+    ImageId &id = image_ids[tile_num];
+    if (id == NO_IMAGE) {
+        id = ResourceManager::instance().getImageId(tileTextureName(tile_num));
+    }
+    return ResourceManager::instance().getImage(id);
 }
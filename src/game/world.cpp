@@ -0,0 +1,200 @@
+//
+//  Copyright © 2018 Vande Griek, Eric. All rights reserved.
+//
+
+#include "world.h"
+#include "tile.h"
+#include "systems.h"
+
+/**
+ Get a handle for a new entity, reusing the index of one that was removed
+ */
+EntityId World::create() {
+    Uint32 index;
+    if (!free_indices.empty()) {
+        index = free_indices.back();
+        free_indices.pop_back();
+    } else {
+        index = Uint32(entity_states.size());
+        if (index >= MAX_ENTITIES) {
+            SDL_Log("Too many entities, can't create more than %u\n", MAX_ENTITIES);
+            throw std::runtime_error("Too many entities");
+        }
+        entity_states.push_back(ENTITY_FREE);
+        generations.push_back(0);
+    }
+    entity_states[index] = ENTITY_ALIVE;
+    ++entity_count;
+    return makeEntity(index, generations[index]);
+}
+
+/**
+ Create a tile entity for tile_num with its top left at the given world position.
+ Tiles only collide, they are drawn by the chunk they are baked into.
+ */
+EntityId World::createTile(int tile_num, int x_pos, int y_pos) {
+    EntityId entity = create();
+    Uint8 flags = 0;
+    if (tile_num == TileNum::DAMAGE) {
+        flags = COLLIDER_BOUNCY | COLLIDER_HIT_BACK;
+        damage.add(entity, {DAMAGE_TILE_DAMAGE});
+        emitters.add(entity, {0});
+    } else if (tile_num == TileNum::GOAL) {
+        flags = COLLIDER_GOAL;
+    }
+    colliders.add(entity, {{x_pos, y_pos, TILE_SIDE, TILE_SIDE}, flags});
+    return entity;
+}
+
+/**
+ Create a player or enemy of the passed in type with its top left at the given world position.
+ The being points at type, so it has to outlive the being.
+ */
+EntityId World::createBeing(const BeingType &type, int x_pos, int y_pos) {
+    EntityId entity = create();
+
+    Uint8 flags = 0;
+    if (type.bouncy) {
+        flags |= COLLIDER_BOUNCY;
+    }
+    if (type.hit_back_when_hopped_on) {
+        flags |= COLLIDER_HIT_BACK;
+    }
+    colliders.add(entity, {{x_pos, y_pos, type.width, type.height}, flags});
+    kinematics.add(entity, {0, 0, false});
+    locomotion.add(entity, {0, 0, 0, 0});
+    health.add(entity, {type.hp, 0});
+    damage.add(entity, {type.damage});
+    if (type.action_type != ActionType::NONE) {
+        // the same being in the same level always makes the same choices
+        ai.add(entity, {0, XorShift(mixSeed(mixSeed(seed, Uint32(x_pos)), Uint32(y_pos)))});
+    }
+
+    SpriteView view;
+    view.sprite.init(type.frame_config);
+    view.facing = Facing::RIGHT;
+    sprites.add(entity, view);
+
+    types.add(entity, &type);
+    return entity;
+}
+
+/**
+ Take an entity and all of its components out of the world right away.
+ Its index may be handed out again, with a new generation so the old handle stays stale.
+ Nothing happens if the handle is already stale.
+ Use destroy() while systems are running.
+ */
+void World::remove(EntityId entity) {
+    if (!isValid(entity)) {
+        return;
+    }
+    colliders.remove(entity);
+    kinematics.remove(entity);
+    locomotion.remove(entity);
+    health.remove(entity);
+    damage.remove(entity);
+    ai.remove(entity);
+    sprites.remove(entity);
+    emitters.remove(entity);
+    types.remove(entity);
+
+    Uint32 index = entityIndex(entity);
+    entity_states[index] = ENTITY_FREE;
+    generations[index] = (generations[index] + 1) & ENTITY_GENERATION_MASK;
+    free_indices.push_back(index);
+    --entity_count;
+}
+
+/**
+ Mark an entity to be removed at the end of the tick
+ */
+void World::destroy(EntityId entity) {
+    if (isValid(entity) && entity_states[entityIndex(entity)] == ENTITY_ALIVE) {
+        entity_states[entityIndex(entity)] = ENTITY_DESTROYED;
+        pending_removal.push_back(entity);
+    }
+}
+
+/**
+ True if the handle refers to an entity that hasn't been removed, even if it has been destroyed
+ */
+bool World::isValid(EntityId entity) {
+    Uint32 index = entityIndex(entity);
+    return index < entity_states.size() && entity_states[index] != ENTITY_FREE
+           && generations[index] == entityGeneration(entity);
+}
+
+/**
+ True if the entity has been destroyed but not removed yet
+ */
+bool World::isDestroyed(EntityId entity) {
+    return isValid(entity) && entity_states[entityIndex(entity)] == ENTITY_DESTROYED;
+}
+
+/**
+ Remove every entity destroyed since the last call, except keep which stays destroyed
+ in the world until it is removed directly.
+ Only touches the destroyed entities, the cost doesn't grow with the size of the world.
+ */
+void World::removeDestroyed(EntityId keep) {
+    size_t kept = 0;
+    for (EntityId entity : pending_removal) {
+        if (entity == keep && isDestroyed(entity)) {
+            pending_removal[kept++] = entity;
+        } else {
+            // stale if it was already removed directly
+            remove(entity);
+        }
+    }
+    pending_removal.resize(kept);
+}
+
+/**
+ Make room for this many entities up front, so a level loading in doesn't grow the arrays one step at a time.
+ Only colliders are reserved for all of them, every tile and being has one.
+ */
+void World::reserve(size_t entities) {
+    entity_states.reserve(entities);
+    generations.reserve(entities);
+    free_indices.reserve(entities);
+    colliders.reserve(entities);
+}
+
+/**
+ Remove every entity.
+ The arrays keep their memory so the next level reuses it.
+ Generations are kept too, handles from before are still stale afterwards.
+ */
+void World::clear() {
+    colliders.clear();
+    kinematics.clear();
+    locomotion.clear();
+    health.clear();
+    damage.clear();
+    ai.clear();
+    sprites.clear();
+    emitters.clear();
+    types.clear();
+    free_indices.clear();
+    for (Uint32 index = Uint32(entity_states.size()); index > 0; --index) {
+        // hand out low indices first
+        if (entity_states[index - 1] != ENTITY_FREE) {
+            entity_states[index - 1] = ENTITY_FREE;
+            generations[index - 1] = (generations[index - 1] + 1) & ENTITY_GENERATION_MASK;
+        }
+        free_indices.push_back(index - 1);
+    }
+    pending_removal.clear();
+    collisions.clear();
+    entity_count = 0;
+}
+
+/**
+ Called when entity runs into a goal, or a goal runs into it
+ */
+void World::hitGoal(EntityId entity) {
+    if (goal_callback) {
+        goal_callback(entity);
+    }
+}
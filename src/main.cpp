@@ -16,19 +16,128 @@
  - Press Q to quit
  - Esc opens pause menu
  - The F key toggles an FPS display
+ - F11 toggles fullscreen
  
  The main game class is Hopman
 */
 
 #include "hopman.h"
+#include "level_generator.h"
+#include "soft_mixer.h"
+
+constexpr int LEVEL_BENCH_ITERATIONS = 100;
+constexpr int MIXER_BENCH_BUFFERS = 1000;
+constexpr int MIXER_BENCH_VOICES[] = {16, 128, 512};
+
+/**
+ Write a generated level from command line arguments:
+ out_file seed width height [platform_density enemy_density hazard_density]
+ */
+int generateLevelCommand(int argc, char *argv[]) {
+    if (argc < 4) {
+        SDL_Log("Usage: --generate-level out_file seed width height "
+                "[platform_density enemy_density hazard_density]\n");
+        return 1;
+    }
+    LevelGenParams params;
+    try {
+        params.seed = Uint32(std::stoul(argv[1]));
+        params.width = std::stoi(argv[2]);
+        params.height = std::stoi(argv[3]);
+        if (argc > 4) {
+            params.platform_density = std::stof(argv[4]);
+        }
+        if (argc > 5) {
+            params.enemy_density = std::stof(argv[5]);
+        }
+        if (argc > 6) {
+            params.hazard_density = std::stof(argv[6]);
+        }
+        generateLevel(params).saveText(argv[0]);
+    } catch (std::exception &ex) {
+        SDL_Log("Failed to generate level: %s\n", ex.what());
+        return 1;
+    }
+    SDL_Log("Wrote %s (%dx%d, seed %u)\n", argv[0], params.width, params.height, params.seed);
+    return 0;
+}
 
 /**
  It all starts here
+ Run with --bench-levels to time loading each level in the text and compiled formats,
+ or --bench-levels followed by level files to time just those.
+ Run with --generate-level to write a random level, see generateLevelCommand.
+ Run with --bench-mixer to time the software mixer, optionally followed by a number of voices.
+ Options for running the game, any number can be given:
+ --hot-reload to reload levels and images when they are saved,
+ --soft-mixer to mix sound effects in software,
+ --low-latency to use a small audio buffer so sounds play sooner,
+ --audio-buffer followed by the audio buffer size in samples,
+ --seed followed by the random seed a previous run logged, so enemies make the same choices.
  */
-int main() {
+int main(int argc, char *argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--generate-level") {
+        return generateLevelCommand(argc - 2, argv + 2);
+    }
+
+    if (argc > 2 && std::string(argv[1]) == "--bench-levels") {
+        for (int arg = 2; arg < argc; ++arg) {
+            benchmarkLevelLoading(argv[arg], LEVEL_BENCH_ITERATIONS);
+        }
+        return 0;
+    } else if (argc > 1 && std::string(argv[1]) == "--bench-levels") {
+        // stop at the first missing level number
+        for (int lvl = 0; ; ++lvl) {
+            std::string lvl_file = LEVEL_FILE_PREFIX + std::to_string(lvl);
+            if (!std::ifstream(lvl_file).good()) {
+                break;
+            }
+            benchmarkLevelLoading(lvl_file, LEVEL_BENCH_ITERATIONS);
+        }
+        return 0;
+    }
+
+    if (argc > 1 && std::string(argv[1]) == "--bench-mixer") {
+        if (argc > 2) {
+            try {
+                benchmarkSoftMixer(std::stoi(argv[2]), MIXER_BENCH_BUFFERS);
+            } catch (std::exception &ex) {
+                SDL_Log("Usage: --bench-mixer [voices] (%s)\n", ex.what());
+                return 1;
+            }
+        } else {
+            for (int voices : MIXER_BENCH_VOICES) {
+                benchmarkSoftMixer(voices, MIXER_BENCH_BUFFERS);
+            }
+        }
+        return 0;
+    }
+
+    bool hot_reload = false;
+    AudioConfig audio_config;
+    Uint32 seed = 0;
+    for (int arg = 1; arg < argc; ++arg) {
+        std::string option = argv[arg];
+        try {
+            if (option == "--hot-reload") {
+                hot_reload = true;
+            } else if (option == "--soft-mixer") {
+                audio_config.soft_mixer = true;
+            } else if (option == "--low-latency") {
+                audio_config.buffer_samples = AUDIO_LOW_LATENCY_SAMPLES;
+            } else if (option == "--audio-buffer" && arg + 1 < argc) {
+                audio_config.buffer_samples = std::stoi(argv[++arg]);
+            } else if (option == "--seed" && arg + 1 < argc) {
+                seed = Uint32(std::stoul(argv[++arg]));
+            }
+        } catch (std::exception &ex) {
+            SDL_Log("Usage: %s followed by a number, not %s (%s)\n", option.c_str(), argv[arg], ex.what());
+            return 1;
+        }
+    }
     Hopman hpm = Hopman();
 
-    hpm.init();
+    hpm.init(hot_reload, audio_config, seed);
     int ret = hpm.play();
     hpm.shutdown();
 
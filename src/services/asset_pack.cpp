@@ -0,0 +1,159 @@
+//
+//  Copyright © 2018 Vande Griek, Eric. All rights reserved.
+//
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "asset_pack.h"
+
+/**
+ Hash an asset name the same way asset_packer.py does, 64 bit FNV-1a
+ */
+Uint64 hashAssetName(const std::string &name) {
+    Uint64 value = 0xcbf29ce484222325ULL;
+    for (unsigned char chr : name) {
+        value ^= chr;
+        value *= 0x100000001b3ULL;
+    }
+    return value;
+}
+
+/**
+ Unmap the pack if it is open
+ */
+AssetPack::~AssetPack() {
+    close();
+}
+
+/**
+ Map a pack file and check that its index fits in the file.
+ Returns false if there is no pack file, throws if it is invalid.
+ */
+bool AssetPack::open(const std::string &filename) {
+    close();
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || size_t(file_stat.st_size) < sizeof(AssetPackHeader)) {
+        ::close(fd);
+        throw std::runtime_error("Asset pack is too small: " + filename);
+    }
+    size_t file_len = file_stat.st_size;
+    void *addr = mmap(NULL, file_len, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        throw std::runtime_error("Failed to map asset pack: " + filename);
+    }
+
+    AssetPackHeader header;
+    SDL_memcpy(&header, addr, sizeof(header));
+    Uint32 count = SDL_SwapLE32(header.entry_count);
+    Uint64 index_end = SDL_SwapLE32(header.index_offset) + Uint64(count) * sizeof(AssetPackEntry);
+    Uint64 names_end = Uint64(SDL_SwapLE32(header.names_offset)) + SDL_SwapLE32(header.names_size);
+    std::string error;
+    if (SDL_memcmp(header.magic, ASSET_PACK_MAGIC, sizeof(header.magic)) != 0) {
+        error = "bad magic";
+    } else if (SDL_SwapLE16(header.version) != ASSET_PACK_VERSION) {
+        error = "unsupported version " + std::to_string(SDL_SwapLE16(header.version));
+    } else if (index_end > file_len || names_end > file_len) {
+        error = "index is out of bounds";
+    }
+    if (!error.empty()) {
+        munmap(addr, file_len);
+        throw std::runtime_error("Failed to read asset pack " + filename + ": " + error);
+    }
+
+    data = static_cast<const Uint8*>(addr);
+    len = file_len;
+    entry_count = count;
+    return true;
+}
+
+/**
+ Unmap the pack.
+ Anything still reading from it must be freed first.
+ */
+void AssetPack::close() {
+    if (data != NULL) {
+        munmap(const_cast<Uint8*>(data), len);
+    }
+    data = NULL;
+    len = 0;
+    entry_count = 0;
+}
+
+/**
+ Read an index entry
+ */
+AssetPackEntry AssetPack::getEntry(int idx) const {
+    AssetPackHeader header;
+    SDL_memcpy(&header, data, sizeof(header));
+    AssetPackEntry entry;
+    SDL_memcpy(&entry, data + SDL_SwapLE32(header.index_offset) + idx * sizeof(AssetPackEntry), sizeof(entry));
+    entry.hash = SDL_SwapLE64(entry.hash);
+    entry.name_offset = SDL_SwapLE32(entry.name_offset);
+    entry.name_len = SDL_SwapLE32(entry.name_len);
+    entry.data_offset = SDL_SwapLE32(entry.data_offset);
+    entry.data_size = SDL_SwapLE32(entry.data_size);
+    return entry;
+}
+
+/**
+ Find an asset by its path relative to the Assets directory.
+ Binary searches the index by hash, then checks the name.
+ Returns false if the asset isn't in the pack.
+ */
+bool AssetPack::find(const std::string &name, const Uint8 *&asset_data, size_t &asset_size) const {
+    if (data == NULL) {
+        return false;
+    }
+    Uint64 hash = hashAssetName(name);
+    int low = 0;
+    int high = entry_count;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (getEntry(mid).hash < hash) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low == entry_count) {
+        return false;
+    }
+
+    AssetPackEntry entry = getEntry(low);
+    AssetPackHeader header;
+    SDL_memcpy(&header, data, sizeof(header));
+    Uint64 name_end = Uint64(entry.name_offset) + entry.name_len;
+    Uint64 data_end = Uint64(entry.data_offset) + entry.data_size;
+    if (entry.hash != hash || name_end > SDL_SwapLE32(header.names_size) || data_end > len) {
+        return false;
+    }
+    const char *entry_name = reinterpret_cast<const char*>(data + SDL_SwapLE32(header.names_offset)
+                                                           + entry.name_offset);
+    if (name.compare(0, std::string::npos, entry_name, entry.name_len) != 0) {
+        return false;
+    }
+
+    asset_data = data + entry.data_offset;
+    asset_size = entry.data_size;
+    return true;
+}
+
+/**
+ Open an asset for reading straight out of the mapped pack.
+ Returns NULL if the asset isn't in the pack.
+ */
+SDL_RWops* AssetPack::openAsset(const std::string &name) const {
+    const Uint8 *asset_data;
+    size_t asset_size;
+    if (!find(name, asset_data, asset_size)) {
+        return NULL;
+    }
+    return SDL_RWFromConstMem(asset_data, int(asset_size));
+}
@@ -3,6 +3,8 @@
 //  Copyright © 2018 Vande Griek, Eric. All rights reserved.
 //
 
+#include <cmath>
+#include <algorithm>
 #include "audio.h"
 
 /**
@@ -26,38 +28,391 @@ Audio& Audio::instance() {
 /**
  Set up
  */
-void Audio::init() {
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
-        SDL_Log("%s\n", Mix_GetError());
-        throw std::runtime_error("Failed to init audio");
-    }
+void Audio::init(const AudioConfig &config) {
     bg_track = NULL;
+    reopens = 0;
+    underrun_check_ts = SDL_GetTicks();
+    underruns_at_check = 0;
+    openDevice(std::max(AUDIO_MIN_BUFFER_SAMPLES, config.buffer_samples));
+    if (config.soft_mixer && soft_mixer.init(buffer_samples)) {
+        // the mixer keeps converted copies of sounds, they go when the sound does
+        ResourceManager::instance().setSoundUnloadCallback(std::bind(&Audio::forgetSound, this,
+                                                                     std::placeholders::_1));
+    }
+
+    queue_sem = SDL_CreateSemaphore(0);
+    if (queue_sem == NULL) {
+        SDL_Log("%s\n", SDL_GetError());
+        throw std::runtime_error("Failed to create audio queue");
+    }
+    stopping = false;
+    sounds_handled = 0;
+    sounds_played = 0;
+    sounds_merged = 0;
+    sounds_limited = 0;
+    sounds_preempted = 0;
+    voices_dropped = 0;
+    sounds_queued = 0;
+    sounds_dropped = 0;
+    sounds_culled = 0;
+    for (auto &voice : soft_voices) {
+        voice = Voice();
+    }
+    next_soft_voice_id = 0;
+    audio_thread = std::thread(&Audio::audioLoop, this);
 }
 
 /**
  Tear down
  */
 void Audio::shutdown() {
+    stopping = true;
+    SDL_SemPost(queue_sem);
+    audio_thread.join();
+    SDL_DestroySemaphore(queue_sem);
+    Mix_ChannelFinished(NULL);
+
+    AudioLatencyStats latency = getLatencyStats();
+    SDL_Log("Audio buffer: %d samples, %.1f ms, buffers came every %.2f ms on average, %.2f ms at most, "
+            "%u underruns, %u reopens\n", latency.buffer_samples, latency.buffer_ms, latency.avg_interval_ms,
+            latency.max_interval_ms, latency.underruns, latency.reopens);
+    if (soft_mixer.isEnabled()) {
+        SoftMixerStats mix_stats = soft_mixer.getStats();
+        SDL_Log("Software mixer: %u buffers, %.4f ms average, %.4f ms max, %u voices at most, %u dropped\n",
+                mix_stats.buffers, mix_stats.avg_ms, mix_stats.max_ms, mix_stats.peak_voices, mix_stats.dropped);
+        ResourceManager::instance().setSoundUnloadCallback(nullptr);
+        soft_mixer.shutdown();
+    }
+
+    VoiceStats stats = getVoiceStats();
+    SDL_Log("Sounds played: %u, merged: %u, over the instance limit: %u, preempted: %u, dropped: %u, out of range: %u\n",
+            stats.played, stats.merged, stats.limited, stats.preempted, stats.dropped, stats.culled);
+
     Mix_Quit();
 }
 
 /**
- Record the time that this sound was played
+ Open the audio device with buffers of the given number of samples
+ and set up the channels on it
+ */
+void Audio::openDevice(int samples) {
+    if (Mix_OpenAudio(AUDIO_FREQUENCY, MIX_DEFAULT_FORMAT, 2, samples) < 0) {
+        SDL_Log("%s\n", Mix_GetError());
+        throw std::runtime_error("Failed to init audio");
+    }
+    buffer_samples = samples;
+    Uint16 format;
+    int channels;
+    Mix_QuerySpec(&frequency, &format, &channels);
+
+    // keep track of which channels are free
+    Mix_AllocateChannels(SOUND_CHANNELS);
+    for (int channel = 0; channel < SOUND_CHANNELS; ++channel) {
+        channel_done[channel] = false;
+        voices[channel] = Voice();
+    }
+    Mix_ChannelFinished(&Audio::channelFinished);
+
+    last_buffer_ts = 0;
+    interval_ticks = 0;
+    max_interval_ticks = 0;
+    buffers_timed = 0;
+    underruns = 0;
+    Mix_RegisterEffect(MIX_CHANNEL_POST, &Audio::timeBuffer, NULL, this);
+}
+
+/**
+ Close the audio device and open it again with a different buffer size.
+ Sounds that were playing are stopped, the music starts over.
+ */
+void Audio::reopenDevice(int samples) {
+    std::lock_guard<std::mutex> lock(device_mutex);
+    Uint32 total_underruns = underruns;
+    Mix_CloseAudio();
+    openDevice(samples);
+    // the counts are for the whole game, not just this device
+    underruns = total_underruns;
+    underruns_at_check = total_underruns;
+    ++reopens;
+
+    if (soft_mixer.isEnabled()) {
+        soft_mixer.attach(samples);
+    }
+    if (bg_track != NULL) {
+        Mix_PlayMusic(bg_track, -1);
+    }
+    SDL_Log("Audio underruns, reopened the device with %d sample buffers\n", samples);
+}
+
+/**
+ Called by the mixer on the device thread for every buffer, after mixing it.
+ Times how far apart buffers are, one coming much later than the buffer length means the device ran out.
+ */
+void Audio::timeBuffer(int, void*, int, void *udata) {
+    Audio *audio = static_cast<Audio*>(udata);
+    Uint64 now = SDL_GetPerformanceCounter();
+    Uint64 last = audio->last_buffer_ts.exchange(now);
+    if (last == 0 || ++audio->buffers_timed <= AUDIO_WARMUP_BUFFERS) {
+        return;
+    }
+
+    Uint64 interval = now - last;
+    audio->interval_ticks += interval;
+    if (interval > audio->max_interval_ticks) {
+        audio->max_interval_ticks = interval;
+    }
+    Uint64 expected = SDL_GetPerformanceFrequency() * audio->buffer_samples / audio->frequency;
+    if (interval > expected * AUDIO_UNDERRUN_FACTOR) {
+        ++audio->underruns;
+    }
+}
+
+/**
+ Check for underruns, call once a frame.
+ Too many in a short time and the device is reopened with a bigger buffer.
+ */
+void Audio::update() {
+    Uint32 now = SDL_GetTicks();
+    if (now - underrun_check_ts < AUDIO_UNDERRUN_WINDOW_MS) {
+        return;
+    }
+    Uint32 recent = underruns - underruns_at_check;
+    underrun_check_ts = now;
+    underruns_at_check = underruns;
+    if (recent >= AUDIO_UNDERRUN_LIMIT && buffer_samples < AUDIO_BUFFER_SAMPLES) {
+        reopenDevice(std::min(buffer_samples * 2, AUDIO_BUFFER_SAMPLES));
+    }
+}
+
+/**
+ Get the buffer size and how evenly buffers have been coming
+ */
+AudioLatencyStats Audio::getLatencyStats() {
+    double ms_per_tick = 1000.0 / SDL_GetPerformanceFrequency();
+    AudioLatencyStats stats;
+    stats.buffer_samples = buffer_samples;
+    stats.buffer_ms = buffer_samples * 1000.0 / frequency;
+    stats.buffers = buffers_timed > Uint32(AUDIO_WARMUP_BUFFERS) ? buffers_timed - AUDIO_WARMUP_BUFFERS : 0;
+    stats.avg_interval_ms = stats.buffers > 0 ? interval_ticks * ms_per_tick / stats.buffers : 0;
+    stats.max_interval_ms = max_interval_ticks * ms_per_tick;
+    stats.underruns = underruns;
+    stats.reopens = reopens;
+    return stats;
+}
+
+/**
+ Play queued sounds on the audio thread until shutdown
+ */
+void Audio::audioLoop() {
+    while (true) {
+        SDL_SemWait(queue_sem);
+        if (stopping) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(device_mutex);
+        std::vector<SoundId> unloaded;
+        {
+            std::lock_guard<std::mutex> forget_lock(forget_mutex);
+            unloaded.swap(forgotten);
+        }
+        for (SoundId sound : unloaded) {
+            soft_mixer.forget(sound);
+        }
+        SoundEvent event;
+        while (sound_queue.pop(event)) {
+            startVoice(event);
+            ++sounds_handled;
+        }
+        // taking the lock means a flush that saw the old count is already waiting, so it gets woken
+        {
+            std::lock_guard<std::mutex> flush_lock(flush_mutex);
+        }
+        flush_cond.notify_all();
+    }
+}
+
+/**
+ Tell the audio thread a sound was unloaded, so the software mixer drops its copy of it.
+ Called on the game thread.
+ */
+void Audio::forgetSound(SoundId sound) {
+    {
+        std::lock_guard<std::mutex> lock(forget_mutex);
+        forgotten.push_back(sound);
+    }
+    SDL_SemPost(queue_sem);
+}
+
+/**
+ Called by the mixer when a channel stops playing, on the mixer's thread.
+ Can't call back into the mixer, so it only flags the channel.
  */
-void Audio::setPlayed(const std::string &track_name) {
-    last_played_map[track_name] = SDL_GetTicks();
+void Audio::channelFinished(int channel) {
+    if (channel >= 0 && channel < SOUND_CHANNELS) {
+        Audio::instance().channel_done[channel] = true;
+    }
+}
+
+/**
+ Start a sound on a channel, or a voice of the software mixer when it is enabled,
+ unless it is merged, over its instance limit, or there is no channel it is important enough to take.
+ Runs on the audio thread.
+ */
+void Audio::startVoice(const SoundEvent &event) {
+    // free the channels that finished since the last sound
+    for (int channel = 0; channel < SOUND_CHANNELS; ++channel) {
+        if (channel_done[channel].exchange(false)) {
+            voices[channel].sound = NO_SOUND;
+        }
+    }
+
+    Uint32 now = SDL_GetTicks();
+    if (event.sound >= SoundId(last_started.size())) {
+        last_started.resize(event.sound + 1, 0);
+    }
+    Uint32 &started = last_started[event.sound];
+    if (started != 0 && now - started < SOUND_MERGE_WINDOW_MS) {
+        // sounds just as loud if it was already started this frame
+        ++sounds_merged;
+        return;
+    }
+
+    bool soft = soft_mixer.isEnabled();
+    Voice *pool = voices;
+    int pool_size = SOUND_CHANNELS;
+    if (soft) {
+        pool = soft_voices;
+        pool_size = SOFT_MIXER_VOICES;
+        // software voices are over once their length has played
+        for (auto &voice : soft_voices) {
+            if (voice.sound != NO_SOUND && Sint32(now - voice.end_ts) >= 0) {
+                voice.sound = NO_SOUND;
+            }
+        }
+    }
+
+    int instances = 0;
+    for (int idx = 0; idx < pool_size; ++idx) {
+        if (pool[idx].sound == event.sound) {
+            ++instances;
+        }
+    }
+    if (instances >= MAX_SOUND_INSTANCES) {
+        ++sounds_limited;
+        return;
+    }
+
+    int channel = findVoice(pool, pool_size, event);
+    if (channel < 0) {
+        ++voices_dropped;
+        return;
+    }
+    if (soft) {
+        if (!startSoftVoice(event, soft_voices[channel], now)) {
+            ++voices_dropped;
+            return;
+        }
+        started = now;
+        ++sounds_played;
+        return;
+    }
+    if (voices[channel].sound != NO_SOUND) {
+        Mix_HaltChannel(channel);
+        // halting flags the channel as finished, but it is about to be used again
+        channel_done[channel] = false;
+        ++sounds_preempted;
+    }
+
+    // 255 on both sides turns panning back off
+    Mix_SetPanning(channel, event.left, event.right);
+    if (Mix_PlayChannel(channel, event.chunk, 0) < 0) {
+        ++voices_dropped;
+        return;
+    }
+    voices[channel] = {event.sound, event.priority, now, 0, 0};
+    started = now;
+    ++sounds_played;
+}
+
+/**
+ Start a sound on the software mixer in place of voice,
+ stopping the sound voice was playing if it hasn't finished.
+ Returns false if the sound couldn't be started.
+ */
+bool Audio::startSoftVoice(const SoundEvent &event, Voice &voice, Uint32 now) {
+    if (voice.sound != NO_SOUND) {
+        if (!soft_mixer.stop(voice.id)) {
+            return false;
+        }
+        voice.sound = NO_SOUND;
+        ++sounds_preempted;
+    }
+    Uint32 id = next_soft_voice_id++;
+    if (!soft_mixer.play(event.sound, event.chunk, event.left / float(UINT8_MAX), event.right / float(UINT8_MAX), id)) {
+        return false;
+    }
+    // chunks are 16 bit stereo
+    Uint32 length_ms = Uint32(Uint64(event.chunk->alen) / (2 * sizeof(Sint16)) * 1000 / frequency);
+    voice = {event.sound, event.priority, now, now + length_ms, id};
+    return true;
+}
+
+/**
+ Find the channel or software mixer voice in pool to play a sound on.
+ A free one if there is one, otherwise the oldest sound with the lowest priority,
+ if that is lower than the new sound's.
+ Returns -1 if the sound shouldn't be played.
+ */
+int Audio::findVoice(const Voice *pool, int count, const SoundEvent &event) {
+    int best = -1;
+    for (int idx = 0; idx < count; ++idx) {
+        const Voice &voice = pool[idx];
+        if (voice.sound == NO_SOUND) {
+            return idx;
+        }
+        if (voice.priority >= event.priority) {
+            continue;
+        }
+        if (best < 0 || voice.priority < pool[best].priority
+            || (voice.priority == pool[best].priority && voice.start_ts < pool[best].start_ts)) {
+            best = idx;
+        }
+    }
+    return best;
+}
+
+/**
+ Get counts of what happened to the sounds played so far
+ */
+VoiceStats Audio::getVoiceStats() {
+    VoiceStats stats;
+    stats.played = sounds_played;
+    stats.merged = sounds_merged;
+    stats.limited = sounds_limited;
+    stats.preempted = sounds_preempted;
+    stats.dropped = voices_dropped + sounds_dropped;
+    stats.culled = sounds_culled;
+    return stats;
+}
+
+/**
+ Wait until the audio thread has started every queued sound.
+ Call before freeing sounds that may still be in the queue.
+ */
+void Audio::flush() {
+    std::unique_lock<std::mutex> lock(flush_mutex);
+    flush_cond.wait(lock, [this] { return sounds_handled == sounds_queued; });
 }
 
 /**
  Get the timestamp for the last time the passed in sound was played.
  Returns 0 if this is the first time it was played.
  */
-Uint32 Audio::getLastPlayed(const std::string &sound_name) {
-    auto item = last_played_map.find(sound_name);
-    if (item == last_played_map.end()) {
+Uint32 Audio::getLastPlayed(SoundId sound) {
+    if (sound == NO_SOUND || sound >= int(last_played.size())) {
         return 0;
     }
-    return item->second;
+    return last_played[sound];
 }
 
 /**
@@ -80,19 +435,80 @@ void Audio::setBgTrack(const std::string &track_name) {
 
     bg_track = track;
     Mix_PlayMusic(track, -1);
-    setPlayed(track_name);
 }
 
 /**
  Play a sound effect
  sound_name should be the name of a file in the sounds directory.
  */
-void Audio::playSound(const std::string &sound_name) {
-    if (sound_name.empty()) {
+void Audio::playSound(const std::string &sound_name, SoundPriority priority) {
+    playSound(ResourceManager::instance().getSoundId(sound_name), priority);
+}
+
+/**
+ Play a sound effect by its handle at full volume.
+ Use this for sounds played often, it doesn't look anything up by name.
+ The sound is queued for the audio thread, this doesn't wait for the mixer.
+ */
+void Audio::playSound(SoundId sound, SoundPriority priority) {
+    queueSound(sound, priority, UINT8_MAX, UINT8_MAX);
+}
+
+/**
+ Play a sound effect that comes from a place in the world.
+ It is quieter the further it is from the center of the view, and panned toward the side it is on.
+ Sounds too far away to hear are never sent to the mixer.
+ */
+void Audio::playSoundAt(SoundId sound, int xpos, int ypos, SoundPriority priority) {
+    SDL_Rect view = Graphics::instance().getViewRect();
+    float x_dist = xpos - (view.x + view.w / 2.0f);
+    float y_dist = ypos - (view.y + view.h / 2.0f);
+    float dist = std::sqrt(x_dist * x_dist + y_dist * y_dist);
+    if (dist >= SOUND_AUDIBLE_RADIUS) {
+        // still counts as played, so sounds repeated on a timer don't try again every frame
+        if (sound != NO_SOUND) {
+            setPlayed(sound);
+            ++sounds_culled;
+        }
+        return;
+    }
+
+    float volume = 1.0f;
+    if (dist > SOUND_FULL_VOLUME_RADIUS) {
+        volume = 1.0f - (dist - SOUND_FULL_VOLUME_RADIUS) / (SOUND_AUDIBLE_RADIUS - SOUND_FULL_VOLUME_RADIUS);
+    }
+    float pan = std::max(-SOUND_MAX_PAN, std::min(SOUND_MAX_PAN, x_dist / SOUND_AUDIBLE_RADIUS * 2));
+    // the nearer speaker stays at the full volume, the other fades with the pan
+    Uint8 left = Uint8(UINT8_MAX * volume * std::min(1.0f, 1.0f - pan));
+    Uint8 right = Uint8(UINT8_MAX * volume * std::min(1.0f, 1.0f + pan));
+    queueSound(sound, priority, left, right);
+}
+
+/**
+ Send a sound to the audio thread
+ */
+void Audio::queueSound(SoundId sound, SoundPriority priority, Uint8 left, Uint8 right) {
+    if (sound == NO_SOUND) {
         // don't play anything
         return;
     }
-    Mix_Chunk *sound = ResourceManager::instance().getSound(sound_name);
-    Mix_PlayChannel(-1, sound, 0);
-    setPlayed(sound_name);
+    // loading has to happen on this thread, the resource manager isn't shared
+    Mix_Chunk *chunk = ResourceManager::instance().getSound(sound);
+    if (!sound_queue.push({sound, priority, left, right, chunk})) {
+        ++sounds_dropped;
+        return;
+    }
+    ++sounds_queued;
+    SDL_SemPost(queue_sem);
+    setPlayed(sound);
+}
+
+/**
+ Record the time that this sound was played
+ */
+void Audio::setPlayed(SoundId sound) {
+    if (sound >= int(last_played.size())) {
+        last_played.resize(ResourceManager::instance().getSoundCount(), 0);
+    }
+    last_played[sound] = SDL_GetTicks();
 }
@@ -0,0 +1,136 @@
+//
+//  Copyright © 2018 Vande Griek, Eric. All rights reserved.
+//
+
+#include <algorithm>
+#ifdef LINUX
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <unistd.h>
+#endif
+#include "file_watcher.h"
+
+/**
+ Constructor not used, things are set up in init()
+ */
+FileWatcher::FileWatcher() {}
+
+/**
+ Private destructor
+ */
+FileWatcher::~FileWatcher() {}
+
+/**
+ Get the singleton instance
+ */
+FileWatcher& FileWatcher::instance() {
+    static FileWatcher *instance = new FileWatcher();
+    return *instance;
+}
+
+/**
+ Set up.
+ Nothing is watched until watch() is called.
+ */
+void FileWatcher::init() {
+    notify_fd = -1;
+    watch_dirs.clear();
+    changed.clear();
+}
+
+/**
+ Stop watching everything
+ */
+void FileWatcher::shutdown() {
+#ifdef LINUX
+    if (notify_fd >= 0) {
+        // closing the descriptor removes all of its watches
+        close(notify_fd);
+    }
+#endif
+    notify_fd = -1;
+    watch_dirs.clear();
+}
+
+/**
+ Start watching a directory for files that are written or moved into it.
+ If recursive is true, directories under it are watched too.
+ Returns false if the directory can't be watched.
+ */
+bool FileWatcher::watch(const std::string &dir, bool recursive) {
+#ifdef LINUX
+    if (notify_fd < 0) {
+        notify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (notify_fd < 0) {
+            SDL_Log("Failed to start watching files\n");
+            return false;
+        }
+    }
+
+    std::string dir_path = dir.back() == '/' ? dir : dir + "/";
+    // editors often save by writing a new file and renaming it over the old one
+    int watch_desc = inotify_add_watch(notify_fd, dir_path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (watch_desc < 0) {
+        SDL_Log("Failed to watch %s\n", dir_path.c_str());
+        return false;
+    }
+    watch_dirs[watch_desc] = dir_path;
+
+    if (recursive) {
+        DIR *dir_handle = opendir(dir_path.c_str());
+        if (dir_handle == NULL) {
+            return true;
+        }
+        while (struct dirent *entry = readdir(dir_handle)) {
+            std::string name = entry->d_name;
+            if (name == "." || name == "..") {
+                continue;
+            }
+            struct stat entry_stat;
+            std::string entry_path = dir_path + name;
+            if (stat(entry_path.c_str(), &entry_stat) == 0 && S_ISDIR(entry_stat.st_mode)) {
+                watch(entry_path, true);
+            }
+        }
+        closedir(dir_handle);
+    }
+    return true;
+#else
+    SDL_Log("Watching files is only supported on Linux, not watching %s\n", dir.c_str());
+    return false;
+#endif
+}
+
+/**
+ Get the paths of files that changed since the last poll.
+ Each path is reported once no matter how many times it was written.
+ Never blocks.
+ */
+const std::vector<std::string>& FileWatcher::poll() {
+    changed.clear();
+#ifdef LINUX
+    if (notify_fd < 0) {
+        return changed;
+    }
+
+    alignas(struct inotify_event) char buffer[FILE_WATCHER_BUFFER_SIZE];
+    ssize_t len;
+    while ((len = read(notify_fd, buffer, sizeof(buffer))) > 0) {
+        for (char *pos = buffer; pos < buffer + len;) {
+            struct inotify_event *event = reinterpret_cast<struct inotify_event*>(pos);
+            pos += sizeof(struct inotify_event) + event->len;
+
+            auto dir = watch_dirs.find(event->wd);
+            if (event->len == 0 || (event->mask & IN_ISDIR) || dir == watch_dirs.end()) {
+                continue;
+            }
+            std::string path = dir->second + event->name;
+            if (std::find(changed.begin(), changed.end(), path) == changed.end()) {
+                changed.push_back(path);
+            }
+        }
+    }
+#endif
+    return changed;
+}
@@ -25,34 +25,71 @@ Graphics& Graphics::instance() {
 
 /**
  Set up a window and renderer.
+ window_width and window_height are the logical size of the game view,
+ the real window can be resized and is letterboxed to integer multiples of it.
+ If world_divisor is more than 1 the world is drawn into a target that is
+ world_divisor times smaller than the view and upscaled when it is presented.
  Must be called before use.
  */
-void Graphics::init(int window_width, int window_height) {
+void Graphics::init(int window_width, int window_height, int world_divisor) {
     screen_off_x = 0;
     screen_off_y = 0;
+    fullscreen = false;
+    world_target = NULL;
     this->window_width = window_width;
     this->window_height = window_height;
+    this->world_divisor = 1;
     
     window = SDL_CreateWindow("",
                               SDL_WINDOWPOS_UNDEFINED,
                               SDL_WINDOWPOS_UNDEFINED,
                               window_width,
                               window_height,
-                              SDL_WINDOW_SHOWN);
+                              SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
     if (window == NULL) {
         throw std::runtime_error("Failed to create SDL window");
     }
     
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE);
     if (renderer == NULL) {
         throw std::runtime_error("Failed to create SDL renderer");
     }
+
+    // swapping the GL window directly avoids flickering on OSX,
+    // any other renderer has to go through SDL_RenderPresent
+    SDL_RendererInfo info;
+    SDL_GetRendererInfo(renderer, &info);
+    gl_swap = SDL_strcmp(info.name, "opengl") == 0;
+
+    // SDL scales the logical view to the window and maps mouse events back to it
+    SDL_RenderSetLogicalSize(renderer, window_width, window_height);
+    SDL_RenderSetIntegerScale(renderer, SDL_TRUE);
+
+    // pixel art needs nearest neighbor sampling when it is scaled up
+    SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "0");
+
+    if (world_divisor > 1) {
+        world_target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+                                         window_width / world_divisor, window_height / world_divisor);
+        if (world_target == NULL) {
+            // not fatal, just draw the world at full size
+            SDL_Log("Failed to create world render target, drawing at full size: %s\n", SDL_GetError());
+        } else {
+            // the world is opaque, copy it over without blending
+            SDL_SetTextureBlendMode(world_target, SDL_BLENDMODE_NONE);
+            this->world_divisor = world_divisor;
+        }
+    }
 }
 
 /**
  free the resources used for rendering
  */
 void Graphics::shutdown() {
+    if (world_target != NULL) {
+        SDL_DestroyTexture(world_target);
+        world_target = NULL;
+    }
     SDL_DestroyRenderer(renderer);
     renderer = NULL;
     SDL_DestroyWindow(window);
@@ -76,14 +113,58 @@ void Graphics::clearColor(int red, int green, int blue) {
 }
 
 
+/**
+ Start drawing the world.
+ Everything up to endWorld() goes to the low resolution target if there is one.
+ Draw calls still use full size view coordinates, they are scaled down by the renderer.
+ */
+void Graphics::beginWorld() {
+    if (world_target == NULL) {
+        return;
+    }
+    SDL_SetRenderTarget(renderer, world_target);
+    SDL_RenderSetScale(renderer, 1.0f / world_divisor, 1.0f / world_divisor);
+}
+
+/**
+ Finish drawing the world and upscale it onto the window.
+ Things drawn after this, like the GUI, are drawn at full resolution.
+ */
+void Graphics::endWorld() {
+    if (world_target == NULL) {
+        return;
+    }
+    SDL_SetRenderTarget(renderer, NULL);
+
+    // black out the letterbox around the view
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0xFF);
+    SDL_RenderClear(renderer);
+
+    SDL_RenderCopy(renderer, world_target, NULL, NULL);
+}
+
 /**
  Replace the screen with the frame that has just been drawn
  */
 void Graphics::swapFrame() {
-    //TODO needed for windows? causes flickering on OSX
-    //SDL_RenderPresent(renderer);
-    
-    SDL_GL_SwapWindow(window);
+    if (gl_swap) {
+        // SDL_RenderPresent causes flickering on OSX
+        SDL_GL_SwapWindow(window);
+    } else {
+        SDL_RenderPresent(renderer);
+    }
+}
+
+/**
+ Switch between windowed and desktop fullscreen
+ */
+void Graphics::toggleFullscreen() {
+    fullscreen = !fullscreen;
+    Uint32 flags = fullscreen ? SDL_WINDOW_FULLSCREEN_DESKTOP : 0;
+    if (SDL_SetWindowFullscreen(window, flags) != 0) {
+        SDL_Log("Failed to change fullscreen mode: %s\n", SDL_GetError());
+        fullscreen = !fullscreen;
+    }
 }
 
 /**
@@ -91,6 +91,15 @@ void Input::handleKey(SDL_Scancode key, bool pressed) {
     else if (!pressed && key == KEY_PAUSE) {
         callAction(Action::TOGGLE_PAUSE);
     }
+    else if (!pressed && key == KEY_FULLSCREEN) {
+        callAction(Action::TOGGLE_FULLSCREEN);
+    }
+    else if (!pressed && key == KEY_MEMORY_REPORT) {
+        callAction(Action::MEMORY_REPORT);
+    }
+    else if (!pressed && key == KEY_TIMING_REPORT) {
+        callAction(Action::TIMING_REPORT);
+    }
     else if (!pressed && key == KEY_QUIT) {
         callAction(Action::EXIT_GAME);
     }
@@ -0,0 +1,204 @@
+//
+//  Copyright © 2018 Vande Griek, Eric. All rights reserved.
+//
+
+#include "particles.h"
+
+constexpr float PI = 3.14159265f;
+
+/**
+ Look and movement of each effect, indexed by ParticleEffect
+ */
+static const ParticleConfig PARTICLE_CONFIGS[PARTICLE_EFFECT_COUNT] = {
+    // landing dust, puffs out sideways from the feet
+    {170, 150, 130, 4, 150, 350, 0.03f, 0.12f, -PI + 0.3f, -0.3f, 0.0003f},
+    // death burst, flies out in every direction
+    {200, 40, 40, 4, 400, 900, 0.05f, 0.30f, 0, 2 * PI, 0.0006f},
+    // damage sparks, a quick spray upward
+    {255, 230, 120, 2, 100, 250, 0.10f, 0.35f, -PI + 0.6f, -0.6f, 0.0008f},
+    // embers, drift up off of fire tiles
+    {255, 140, 40, 2, 600, 1200, 0.01f, 0.04f, -PI / 2 - 0.3f, -PI / 2 + 0.3f, -0.00003f},
+};
+
+/**
+ Constructor not used, things are set up in init()
+ */
+Particles::Particles() : rng(0) {}
+
+/**
+ Private destructor
+ */
+Particles::~Particles() {}
+
+/**
+ Get the singleton instance
+ */
+Particles& Particles::instance() {
+    static Particles *instance = new Particles();
+    return *instance;
+}
+
+/**
+ Set up.
+ Reserves all the memory that drawing will need so frames don't allocate.
+ */
+void Particles::init() {
+    for (auto &batch : batches) {
+        batch.reserve(MAX_PARTICLES_PER_EFFECT);
+    }
+    rng = XorShift(SDL_GetTicks());
+    clear();
+}
+
+/**
+ Tear down
+ */
+void Particles::shutdown() {
+    clear();
+}
+
+/**
+ Remove every particle, such as when a level ends
+ */
+void Particles::clear() {
+    for (auto &pool : pools) {
+        pool.count = 0;
+    }
+}
+
+/**
+ Get a random float between low and high
+ */
+float Particles::randomRange(float low, float high) {
+    return low + (high - low) * ((rng.next() & 0xFFFFFF) / float(0x1000000));
+}
+
+/**
+ Spawn count particles of an effect at a position in the world.
+ Particles start up to spread_x / 2 to either side of xpos.
+ Particles that don't fit in the pool are dropped.
+ */
+void Particles::emit(ParticleEffect effect, float xpos, float ypos, int count, float spread_x) {
+    ParticlePool &pool = pools[int(effect)];
+    const ParticleConfig &config = PARTICLE_CONFIGS[int(effect)];
+    int end = std::min(pool.count + count, MAX_PARTICLES_PER_EFFECT);
+    for (int idx = pool.count; idx < end; ++idx) {
+        float angle = randomRange(config.min_angle, config.max_angle);
+        float speed = randomRange(config.min_speed, config.max_speed);
+        float life = randomRange(config.min_life, config.max_life);
+        pool.x[idx] = xpos + randomRange(-spread_x / 2, spread_x / 2);
+        pool.y[idx] = ypos;
+        pool.x_vel[idx] = std::cos(angle) * speed;
+        pool.y_vel[idx] = std::sin(angle) * speed;
+        pool.life[idx] = life;
+        pool.max_life[idx] = life;
+    }
+    pool.count = end;
+}
+
+/**
+ Move every particle forward by delta ms and remove the expired ones
+ */
+void Particles::update(int delta) {
+    for (int effect = 0; effect < PARTICLE_EFFECT_COUNT; ++effect) {
+        updatePool(pools[effect], PARTICLE_CONFIGS[effect].gravity, delta);
+    }
+}
+
+/**
+ Integrate one pool.
+ The loops only touch flat float arrays so the compiler can vectorize them.
+ */
+void Particles::updatePool(ParticlePool &pool, float gravity, float delta) {
+    int count = pool.count;
+    float gravity_step = gravity * delta;
+    for (int idx = 0; idx < count; ++idx) {
+        pool.y_vel[idx] += gravity_step;
+    }
+    for (int idx = 0; idx < count; ++idx) {
+        pool.x[idx] += pool.x_vel[idx] * delta;
+        pool.y[idx] += pool.y_vel[idx] * delta;
+        pool.life[idx] -= delta;
+    }
+
+    // keep the pool packed by moving the last particle into each expired slot
+    int idx = 0;
+    while (idx < count) {
+        if (pool.life[idx] > 0) {
+            ++idx;
+            continue;
+        }
+        --count;
+        pool.x[idx] = pool.x[count];
+        pool.y[idx] = pool.y[count];
+        pool.x_vel[idx] = pool.x_vel[count];
+        pool.y_vel[idx] = pool.y_vel[count];
+        pool.life[idx] = pool.life[count];
+        pool.max_life[idx] = pool.max_life[count];
+    }
+    pool.count = count;
+}
+
+/**
+ Draw every particle.
+ Each effect is drawn with one fill call per fade step.
+ */
+void Particles::render() {
+    SDL_Renderer *renderer = Graphics::instance().getRenderer();
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    for (int effect = 0; effect < PARTICLE_EFFECT_COUNT; ++effect) {
+        renderPool(pools[effect], PARTICLE_CONFIGS[effect]);
+    }
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+}
+
+/**
+ Sort the on-screen particles of a pool into fade steps and draw each step in one batch
+ */
+void Particles::renderPool(ParticlePool &pool, const ParticleConfig &config) {
+    if (pool.count == 0) {
+        return;
+    }
+
+    int screen_off_x, screen_off_y;
+    std::tie(screen_off_x, screen_off_y) = Graphics::instance().getScreenOffsets();
+    int screen_w = Graphics::instance().getWindowWidth();
+    int screen_h = Graphics::instance().getWindowHeight();
+    int half_size = config.size / 2;
+
+    for (auto &batch : batches) {
+        batch.clear();
+    }
+    for (int idx = 0; idx < pool.count; ++idx) {
+        int xpos = int(pool.x[idx]) - screen_off_x - half_size;
+        int ypos = int(pool.y[idx]) - screen_off_y - half_size;
+        if (xpos + config.size < 0 || xpos > screen_w || ypos + config.size < 0 || ypos > screen_h) {
+            // off screen
+            continue;
+        }
+        int step = int(pool.life[idx] * PARTICLE_FADE_STEPS / pool.max_life[idx]);
+        step = std::min(std::max(step, 0), PARTICLE_FADE_STEPS - 1);
+        batches[step].push_back({xpos, ypos, config.size, config.size});
+    }
+
+    SDL_Renderer *renderer = Graphics::instance().getRenderer();
+    for (int step = 0; step < PARTICLE_FADE_STEPS; ++step) {
+        if (batches[step].empty()) {
+            continue;
+        }
+        Uint8 alpha = 255 * (step + 1) / PARTICLE_FADE_STEPS;
+        SDL_SetRenderDrawColor(renderer, config.red, config.green, config.blue, alpha);
+        SDL_RenderFillRects(renderer, batches[step].data(), int(batches[step].size()));
+    }
+}
+
+/**
+ Get the number of live particles across all effects
+ */
+int Particles::liveCount() {
+    int total = 0;
+    for (auto &pool : pools) {
+        total += pool.count;
+    }
+    return total;
+}
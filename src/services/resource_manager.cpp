@@ -31,21 +31,123 @@ void ResourceManager::init() {
         SDL_Log("%s\n", TTF_GetError());
         throw std::runtime_error("Failed to init TTF");
     }
+
+    assets_loaded = 0;
+    load_ticks = 0;
+    placeholder = NULL;
+    Uint64 open_start = SDL_GetPerformanceCounter();
+    if (pack.open(ASSET_PACK_FILE)) {
+        double open_ms = (SDL_GetPerformanceCounter() - open_start) * 1000.0 / SDL_GetPerformanceFrequency();
+        SDL_Log("Opened %s with %d assets in %.3f ms\n", ASSET_PACK_FILE, pack.getEntryCount(), open_ms);
+    } else {
+        SDL_Log("No asset pack, loading assets from %s\n", ASSET_DIR);
+    }
+
+    // set up the image loaders here, doing it lazily on the workers would race
+    IMG_Init(IMG_INIT_PNG);
+    stopping = false;
+    for (int idx = 0; idx < ASSET_WORKER_COUNT; ++idx) {
+        workers.emplace_back(&ResourceManager::workerLoop, this);
+    }
 }
 
 /**
  Tear down
  */
 void ResourceManager::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(job_mutex);
+        stopping = true;
+        jobs.clear();
+    }
+    job_cond.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+    // decoded assets that were never picked up
+    for (auto &job : finished_jobs) {
+        if (job.kind == AssetKind::IMAGE) {
+            SDL_FreeSurface(static_cast<SDL_Surface*>(job.data));
+        } else {
+            Mix_FreeChunk(static_cast<Mix_Chunk*>(job.data));
+        }
+    }
+    finished_jobs.clear();
+    image_slots.clear();
+    sound_slots.clear();
+
     free_images();
     free_text();
     free_music();
     free_sounds();
     free_fonts();
+    if (placeholder != NULL) {
+        SDL_DestroyTexture(placeholder);
+        placeholder = NULL;
+    }
+
+    // music and fonts read from the pack until they are freed
+    pack.close();
 
+    IMG_Quit();
     TTF_Quit();
 }
 
+/**
+ Open an asset for reading.
+ path is the path of its file, such as IMAGE_DIR + name.
+ Comes straight out of the asset pack if it is in there.
+ */
+SDL_RWops* ResourceManager::openAsset(const std::string &path) {
+    std::string asset_dir = ASSET_DIR;
+    if (pack.isOpen() && path.compare(0, asset_dir.size(), asset_dir) == 0) {
+        SDL_RWops *rw = pack.openAsset(path.substr(asset_dir.size()));
+        if (rw != NULL) {
+            return rw;
+        }
+    }
+    return SDL_RWFromFile(path.c_str(), "rb");
+}
+
+/**
+ Read the whole of a text asset, such as a data file.
+ path is the path of its file, such as ASSET_DIR + name.
+ */
+std::string ResourceManager::readText(const std::string &path) {
+    SDL_RWops *rw = openAsset(path);
+    if (rw == NULL) {
+        SDL_Log("%s\n", SDL_GetError());
+        throw std::runtime_error("Failed to open " + path);
+    }
+    Sint64 size = SDL_RWsize(rw);
+    std::string text(size > 0 ? size_t(size) : 0, '\0');
+    size_t read = text.empty() ? 0 : SDL_RWread(rw, &text[0], 1, text.size());
+    SDL_RWclose(rw);
+    if (size < 0 || read != text.size()) {
+        SDL_Log("%s\n", SDL_GetError());
+        throw std::runtime_error("Failed to read " + path);
+    }
+    return text;
+}
+
+/**
+ Add the time since start to the asset loading stats
+ */
+void ResourceManager::countLoad(Uint64 start) {
+    load_ticks += SDL_GetPerformanceCounter() - start;
+    ++assets_loaded;
+}
+
+/**
+ Write how long loading assets has taken so far to the log
+ */
+void ResourceManager::logLoadStats() {
+    double load_ms = load_ticks * 1000.0 / SDL_GetPerformanceFrequency();
+    SDL_Log("Loaded %d assets from %s in %.3f ms\n", assets_loaded,
+            pack.isOpen() ? "the asset pack" : "files", load_ms);
+}
+
 /**
  Unload and destroy objects
  */
@@ -56,6 +158,9 @@ void ResourceManager::free_images() {
         SDL_DestroyTexture(tex);
         ++it;
     }
+    image_map.clear();
+    // handles stay valid, the images are loaded again if they are used
+    std::fill(image_table.begin(), image_table.end(), nullptr);
 }
 
 /**
@@ -90,7 +195,7 @@ void ResourceManager::free_music() {
     while (it != music_map.end()) {
         Mix_Music *obj = it->second;
         Mix_FreeMusic(obj);
-        ++it++;
+        ++it;
     }
 }
 
@@ -102,41 +207,165 @@ void ResourceManager::free_sounds() {
     while (it != sound_map.end()) {
         Mix_Chunk *obj = it->second;
         Mix_FreeChunk(obj);
-        ++it++;
+        ++it;
     }
+    sound_map.clear();
+    // handles stay valid, the sounds are loaded again if they are used
+    std::fill(sound_table.begin(), sound_table.end(), nullptr);
 }
 
 /**
- Load or retrieve the texture for an image
+ Load or retrieve the texture for an image.
+ Images loaded by name are kept until shutdown.
  */
 SDL_Texture* ResourceManager::getImageTexture(const std::string &name) {
+    image_pinned[getImageId(name)] = true;
+    return loadImage(name);
+}
+
+/**
+ Load or retrieve the texture for an image without holding on to it
+ */
+SDL_Texture* ResourceManager::loadImage(const std::string &name) {
     SDL_Texture *texture;
     auto map_val = image_map.find(name);
     
     if (map_val == image_map.end()) {
         // not found, need to initialize
-        std::string filename = IMAGE_DIR + name;
-        SDL_Surface *surf = IMG_Load(filename.c_str());
+        Uint64 load_start = SDL_GetPerformanceCounter();
+        SDL_Surface *surf = decodeImage(name);
         if (surf == NULL) {
             SDL_Log("%s\n", IMG_GetError());
             throw std::runtime_error("Failed to load image: " + name);
         }
-        
+        texture = addImage(name, surf);
+        countLoad(load_start);
+    } else {
+        texture = map_val->second;
+    }
+    
+    return texture;
+}
+
+/**
+ Get a single pixel of PLACEHOLDER_COLOR to stretch over the space of an image that isn't loaded,
+ such as one still loading in the background or one that failed to load.
+ Made the first time it is asked for, the renderer has to exist by then.
+ */
+SDL_Texture* ResourceManager::getPlaceholderImage() {
+    if (placeholder == NULL) {
+        placeholder = SDL_CreateTexture(Graphics::instance().getRenderer(), SDL_PIXELFORMAT_RGBA8888,
+                                        SDL_TEXTUREACCESS_STATIC, 1, 1);
+        if (placeholder == NULL) {
+            SDL_Log("%s\n", SDL_GetError());
+            throw std::runtime_error("Failed to create placeholder image");
+        }
+        Uint32 pixel = (Uint32(PLACEHOLDER_COLOR.r) << 24) | (Uint32(PLACEHOLDER_COLOR.g) << 16)
+                       | (Uint32(PLACEHOLDER_COLOR.b) << 8) | PLACEHOLDER_COLOR.a;
+        SDL_UpdateTexture(placeholder, NULL, &pixel, sizeof(pixel));
+        SDL_SetTextureBlendMode(placeholder, SDL_BLENDMODE_BLEND);
+    }
+    return placeholder;
+}
+
+/**
+ Get the names of every image that is loaded, such as to skip decoding them again on another thread
+ */
+std::set<std::string> ResourceManager::getLoadedImageNames() {
+    std::set<std::string> names;
+    for (auto &item : image_map) {
+        names.insert(item.first);
+    }
+    return names;
+}
+
+/**
+ Read an image into a surface.
+ Only reads the asset pack, which doesn't change once open,
+ and doesn't touch the renderer or the loaded images, so it is safe to call from any thread.
+ Returns NULL if the image couldn't be loaded.
+ */
+SDL_Surface* ResourceManager::decodeImage(const std::string &name) {
+    SDL_RWops *rw = openAsset(IMAGE_DIR + name);
+    if (rw == NULL) {
+        return NULL;
+    }
+    return IMG_Load_RW(rw, 1);
+}
+
+/**
+ Create the texture for an image that was already decoded, unless it is loaded already.
+ Takes ownership of surf.
+ */
+SDL_Texture* ResourceManager::addImage(const std::string &name, SDL_Surface *surf) {
+    SDL_Texture *texture;
+    auto map_val = image_map.find(name);
+    if (map_val == image_map.end()) {
         // create texture from surface
         texture = SDL_CreateTextureFromSurface(Graphics::instance().getRenderer(), surf);
         
-        // free surface
-        SDL_FreeSurface(surf);
-        
         // add texture to map
         image_map.insert({name, texture});
+        auto id = image_ids.find(name);
+        if (id != image_ids.end()) {
+            image_table[id->second] = texture;
+        }
     } else {
         texture = map_val->second;
     }
     
+    // free surface
+    SDL_FreeSurface(surf);
     return texture;
 }
 
+/**
+ Read an image again after it changed on disk and copy it into the texture it was loaded into,
+ so everything holding the texture sees the new image.
+ Images that haven't been loaded are ignored.
+ Returns false if the image couldn't be reloaded, such as when its size changed.
+ */
+bool ResourceManager::reloadImage(const std::string &name) {
+    auto map_val = image_map.find(name);
+    if (map_val == image_map.end()) {
+        return false;
+    }
+    SDL_Texture *texture = map_val->second;
+
+    Uint32 format;
+    int width, height;
+    SDL_QueryTexture(texture, &format, NULL, &width, &height);
+
+    // the changed file is on disk, not in the pack
+    std::string filename = IMAGE_DIR + name;
+    SDL_Surface *surf = IMG_Load(filename.c_str());
+    if (surf == NULL) {
+        SDL_Log("Failed to reload image %s: %s\n", name.c_str(), IMG_GetError());
+        return false;
+    }
+    if (surf->w != width || surf->h != height) {
+        SDL_Log("Can't reload image %s, its size changed from %dx%d to %dx%d\n",
+                name.c_str(), width, height, surf->w, surf->h);
+        SDL_FreeSurface(surf);
+        return false;
+    }
+
+    // the pixels have to match the format the texture was created with
+    SDL_Surface *converted = SDL_ConvertSurfaceFormat(surf, format, 0);
+    SDL_FreeSurface(surf);
+    if (converted == NULL) {
+        SDL_Log("Failed to reload image %s: %s\n", name.c_str(), SDL_GetError());
+        return false;
+    }
+    int result = SDL_UpdateTexture(texture, NULL, converted->pixels, converted->pitch);
+    SDL_FreeSurface(converted);
+    if (result != 0) {
+        SDL_Log("Failed to reload image %s: %s\n", name.c_str(), SDL_GetError());
+        return false;
+    }
+    return true;
+}
+
 /**
  Load or retrieve the texture for an image
  */
@@ -145,11 +374,14 @@ TTF_Font* ResourceManager::getFont(int font_size) {
     auto map_val = font_map.find(font_size);
     
     if (map_val == font_map.end()) {
-        font = TTF_OpenFont(FONT_FILE, font_size);
+        Uint64 load_start = SDL_GetPerformanceCounter();
+        SDL_RWops *rw = openAsset(FONT_FILE);
+        font = rw != NULL ? TTF_OpenFontRW(rw, 1, font_size) : NULL;
         if (font == NULL) {
             SDL_Log("%s\n", TTF_GetError());
             throw std::runtime_error("Failed to load font");
         }
+        countLoad(load_start);
 
         // add font to map
         font_map.insert({font_size, font});
@@ -201,12 +433,15 @@ Mix_Music* ResourceManager::getMusic(const std::string &track_name) {
 
     if (map_val == music_map.end()) {
         // not found, need to initialize
-        std::string filename = MUSIC_DIR + track_name;
-        mix = Mix_LoadMUS(filename.c_str());
+        Uint64 load_start = SDL_GetPerformanceCounter();
+        SDL_RWops *rw = openAsset(MUSIC_DIR + track_name);
+        // music is streamed from rw while it plays
+        mix = rw != NULL ? Mix_LoadMUS_RW(rw, 1) : NULL;
         if (mix == NULL) {
             SDL_Log("%s\n", Mix_GetError());
             throw std::runtime_error("Failed to load music: " + track_name);
         }
+        countLoad(load_start);
         
         // add texture to map
         music_map.insert({track_name, mix});
@@ -218,20 +453,30 @@ Mix_Music* ResourceManager::getMusic(const std::string &track_name) {
 }
 
 /**
- Load or retrieve the object for a sound
+ Load or retrieve the object for a sound.
+ Sounds loaded by name are kept until shutdown.
  */
 Mix_Chunk* ResourceManager::getSound(const std::string &sound_name) {
+    sound_pinned[getSoundId(sound_name)] = true;
+    return loadSound(sound_name);
+}
+
+/**
+ Load or retrieve the object for a sound without holding on to it
+ */
+Mix_Chunk* ResourceManager::loadSound(const std::string &sound_name) {
     Mix_Chunk *mix;
     auto map_val = sound_map.find(sound_name);
     
     if (map_val == sound_map.end()) {
         // not found, need to initialize
-        std::string filename = SOUNDS_DIR + sound_name;
-        mix = Mix_LoadWAV(filename.c_str());
+        Uint64 load_start = SDL_GetPerformanceCounter();
+        mix = decodeSound(sound_name);
         if (mix == NULL) {
             SDL_Log("%s\n", Mix_GetError());
             throw std::runtime_error("Failed to load sound: " + sound_name);
         }
+        countLoad(load_start);
         
         // add texture to map
         sound_map.insert({sound_name, mix});
@@ -241,3 +486,380 @@ Mix_Chunk* ResourceManager::getSound(const std::string &sound_name) {
     
     return mix;
 }
+
+/**
+ Get the handle for an image, giving it one if it doesn't have one yet.
+ The image isn't loaded until getImage is called with the handle.
+ */
+ImageId ResourceManager::getImageId(const std::string &name) {
+    auto map_val = image_ids.find(name);
+    if (map_val != image_ids.end()) {
+        return map_val->second;
+    }
+    ImageId id = ImageId(image_names.size());
+    image_ids.insert({name, id});
+    image_names.push_back(name);
+    auto loaded = image_map.find(name);
+    image_table.push_back(loaded != image_map.end() ? loaded->second : NULL);
+    image_refs.push_back(0);
+    image_pinned.push_back(false);
+    return id;
+}
+
+/**
+ Load or retrieve the texture for an image handle
+ */
+SDL_Texture* ResourceManager::getImage(ImageId id) {
+    SDL_Texture *texture = image_table[id];
+    if (texture == NULL) {
+        texture = loadImage(image_names[id]);
+        image_table[id] = texture;
+    }
+    return texture;
+}
+
+/**
+ Get the handle for a sound, giving it one if it doesn't have one yet.
+ Returns NO_SOUND for an empty name.
+ The sound isn't loaded until getSound is called with the handle.
+ */
+SoundId ResourceManager::getSoundId(const std::string &name) {
+    if (name.empty()) {
+        return NO_SOUND;
+    }
+    auto map_val = sound_ids.find(name);
+    if (map_val != sound_ids.end()) {
+        return map_val->second;
+    }
+    SoundId id = SoundId(sound_names.size());
+    sound_ids.insert({name, id});
+    sound_names.push_back(name);
+    sound_table.push_back(NULL);
+    sound_refs.push_back(0);
+    sound_pinned.push_back(false);
+    return id;
+}
+
+/**
+ Load or retrieve the sound effect for a sound handle
+ */
+Mix_Chunk* ResourceManager::getSound(SoundId id) {
+    Mix_Chunk *sound = sound_table[id];
+    if (sound == NULL) {
+        sound = loadSound(sound_names[id]);
+        sound_table[id] = sound;
+    }
+    return sound;
+}
+
+/**
+ Hold on to an image so it isn't freed
+ */
+void ResourceManager::retainImage(ImageId id) {
+    ++image_refs[id];
+}
+
+/**
+ Let go of an image, freeing it once nothing holds it
+ */
+void ResourceManager::releaseImage(ImageId id) {
+    if (--image_refs[id] == 0 && !image_pinned[id]) {
+        unloadImage(id);
+    }
+}
+
+/**
+ Hold on to a sound so it isn't freed
+ */
+void ResourceManager::retainSound(SoundId id) {
+    ++sound_refs[id];
+}
+
+/**
+ Let go of a sound, freeing it once nothing holds it
+ */
+void ResourceManager::releaseSound(SoundId id) {
+    if (--sound_refs[id] == 0 && !sound_pinned[id]) {
+        unloadSound(id);
+    }
+}
+
+/**
+ Free an image if it is loaded. Its handle stays valid.
+ */
+void ResourceManager::unloadImage(ImageId id) {
+    const std::string &name = image_names[id];
+    auto map_val = image_map.find(name);
+    if (map_val != image_map.end()) {
+        SDL_DestroyTexture(map_val->second);
+        image_map.erase(map_val);
+    }
+    image_table[id] = NULL;
+    // handles keep pointing at the slot, loading it in the background again starts over
+    auto slot = image_slots.find(name);
+    if (slot != image_slots.end()) {
+        slot->second = AssetSlot();
+    }
+}
+
+/**
+ Free a sound if it is loaded. Its handle stays valid.
+ */
+void ResourceManager::unloadSound(SoundId id) {
+    const std::string &name = sound_names[id];
+    auto map_val = sound_map.find(name);
+    if (map_val != sound_map.end()) {
+        Mix_FreeChunk(map_val->second);
+        sound_map.erase(map_val);
+        if (sound_unload_callback) {
+            sound_unload_callback(id);
+        }
+    }
+    sound_table[id] = NULL;
+    auto slot = sound_slots.find(name);
+    if (slot != sound_slots.end()) {
+        slot->second = AssetSlot();
+    }
+}
+
+/**
+ Hold the images and sounds a level uses for as long as the level is running.
+ The ones held for the previous level are let go after, so assets the levels share stay loaded.
+ */
+void ResourceManager::setLevelAssets(const std::vector<ImageId> &images, const std::vector<SoundId> &sounds) {
+    for (ImageId id : images) {
+        retainImage(id);
+    }
+    for (SoundId id : sounds) {
+        retainSound(id);
+    }
+    for (ImageId id : level_images) {
+        releaseImage(id);
+    }
+    for (SoundId id : level_sounds) {
+        releaseSound(id);
+    }
+    level_images = images;
+    level_sounds = sounds;
+
+    freeUnused();
+}
+
+/**
+ Free every image and sound that was loaded through a handle but isn't held by anything,
+ such as ones that finished loading in the background after they were let go.
+ */
+void ResourceManager::freeUnused() {
+    for (ImageId id = 0; id < ImageId(image_names.size()); ++id) {
+        if (image_refs[id] == 0 && !image_pinned[id]) {
+            unloadImage(id);
+        }
+    }
+    for (SoundId id = 0; id < SoundId(sound_names.size()); ++id) {
+        if (sound_refs[id] == 0 && !sound_pinned[id]) {
+            unloadSound(id);
+        }
+    }
+}
+
+/**
+ Write what is loaded and roughly how much memory it takes to the log.
+ Textures are counted at 4 bytes a pixel, sounds by the size of their converted samples.
+ */
+void ResourceManager::logMemoryReport() {
+    SDL_Log("Loaded images:\n");
+    size_t image_bytes = 0;
+    for (auto &item : image_map) {
+        int width = 0, height = 0;
+        SDL_QueryTexture(item.second, NULL, NULL, &width, &height);
+        size_t bytes = size_t(width) * height * 4;
+        image_bytes += bytes;
+
+        ImageId id = getImageId(item.first);
+        std::string held = image_pinned[id] ? "pinned" : "refs " + std::to_string(image_refs[id]);
+        SDL_Log("  %-40s %5dx%-5d %9zu bytes  %s\n", item.first.c_str(), width, height, bytes, held.c_str());
+    }
+
+    size_t text_bytes = 0;
+    for (auto &item : text_map) {
+        int width = 0, height = 0;
+        SDL_QueryTexture(item.second, NULL, NULL, &width, &height);
+        text_bytes += size_t(width) * height * 4;
+    }
+
+    SDL_Log("Loaded sounds:\n");
+    size_t sound_bytes = 0;
+    for (auto &item : sound_map) {
+        sound_bytes += item.second->alen;
+
+        SoundId id = getSoundId(item.first);
+        std::string held = sound_pinned[id] ? "pinned" : "refs " + std::to_string(sound_refs[id]);
+        SDL_Log("  %-40s %9u bytes  %s\n", item.first.c_str(), item.second->alen, held.c_str());
+    }
+
+    SDL_Log("Images: %zu, %zu KB\n", image_map.size(), image_bytes / 1024);
+    SDL_Log("Text: %zu, %zu KB\n", text_map.size(), text_bytes / 1024);
+    SDL_Log("Sounds: %zu, %zu KB\n", sound_map.size(), sound_bytes / 1024);
+    SDL_Log("Music tracks: %zu\n", music_map.size());
+}
+
+/**
+ Read a sound and convert it to the format audio plays at.
+ Safe to call from any thread, like decodeImage.
+ Returns NULL if the sound couldn't be loaded.
+ */
+Mix_Chunk* ResourceManager::decodeSound(const std::string &name) {
+    SDL_RWops *rw = openAsset(SOUNDS_DIR + name);
+    if (rw == NULL) {
+        return NULL;
+    }
+    return Mix_LoadWAV_RW(rw, 1);
+}
+
+/**
+ Start loading an image in the background.
+ The image is decoded on a worker thread and made into a texture during update().
+ The handle gives placeholder until then, it is ready right away if the image was already loaded.
+ Hold the image with retainImage first, if nothing holds it when it finishes loading it is thrown away.
+ */
+AssetHandle<SDL_Texture> ResourceManager::loadImageAsync(const std::string &name, SDL_Texture *placeholder) {
+    auto slot = image_slots.insert({name, AssetSlot()}).first;
+    if (slot->second.state == AssetState::NONE) {
+        slot->second.state = AssetState::PENDING;
+        auto loaded = image_map.find(name);
+        if (loaded != image_map.end()) {
+            slot->second.state = AssetState::READY;
+            slot->second.asset = loaded->second;
+        } else {
+            queueJob(AssetKind::IMAGE, name);
+        }
+    }
+    return AssetHandle<SDL_Texture>(&slot->second, placeholder);
+}
+
+/**
+ Start loading a sound in the background.
+ The handle gives NULL until the sound is ready.
+ Hold the sound with retainSound first, like loadImageAsync.
+ */
+AssetHandle<Mix_Chunk> ResourceManager::loadSoundAsync(const std::string &name) {
+    auto slot = sound_slots.insert({name, AssetSlot()}).first;
+    if (slot->second.state == AssetState::NONE) {
+        slot->second.state = AssetState::PENDING;
+        auto loaded = sound_map.find(name);
+        if (loaded != sound_map.end()) {
+            slot->second.state = AssetState::READY;
+            slot->second.asset = loaded->second;
+        } else {
+            queueJob(AssetKind::SOUND, name);
+        }
+    }
+    return AssetHandle<Mix_Chunk>(&slot->second, NULL);
+}
+
+/**
+ Hand an asset to the worker threads
+ */
+void ResourceManager::queueJob(AssetKind kind, const std::string &name) {
+    {
+        std::lock_guard<std::mutex> lock(job_mutex);
+        jobs.push_back({kind, name, NULL, ""});
+    }
+    job_cond.notify_one();
+}
+
+/**
+ Decode assets on a worker thread until shutdown
+ */
+void ResourceManager::workerLoop() {
+    while (true) {
+        AssetJob job;
+        {
+            std::unique_lock<std::mutex> lock(job_mutex);
+            job_cond.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping) {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        if (job.kind == AssetKind::IMAGE) {
+            job.data = decodeImage(job.name);
+        } else {
+            job.data = decodeSound(job.name);
+        }
+        if (job.data == NULL) {
+            // the error is only readable on this thread
+            job.error = SDL_GetError();
+        }
+
+        std::lock_guard<std::mutex> lock(job_mutex);
+        finished_jobs.push_back(std::move(job));
+    }
+}
+
+/**
+ Finish assets the workers have decoded.
+ Textures can only be created on the main thread, so this has to be called from there, once a frame.
+ */
+void ResourceManager::update() {
+    for (int count = 0; count < MAX_ASSET_UPLOADS_PER_UPDATE; ++count) {
+        AssetJob job;
+        {
+            std::lock_guard<std::mutex> lock(job_mutex);
+            if (finished_jobs.empty()) {
+                return;
+            }
+            job = std::move(finished_jobs.front());
+            finished_jobs.pop_front();
+        }
+        finishJob(job);
+    }
+}
+
+/**
+ Add a decoded asset to the loaded assets and mark its slot ready.
+ If it was loaded some other way in the meantime, that one is kept.
+ Assets that were let go while they were loading are thrown away.
+ */
+void ResourceManager::finishJob(AssetJob &job) {
+    bool is_image = job.kind == AssetKind::IMAGE;
+    auto &slots = is_image ? image_slots : sound_slots;
+    auto found = slots.find(job.name);
+    bool held;
+    if (is_image) {
+        ImageId id = getImageId(job.name);
+        held = image_refs[id] > 0 || image_pinned[id];
+    } else {
+        SoundId id = getSoundId(job.name);
+        held = sound_refs[id] > 0 || sound_pinned[id];
+    }
+    if (found == slots.end() || found->second.state != AssetState::PENDING || !held) {
+        // unloaded while it was being decoded
+        if (is_image) {
+            SDL_FreeSurface(static_cast<SDL_Surface*>(job.data));
+        } else {
+            Mix_FreeChunk(static_cast<Mix_Chunk*>(job.data));
+        }
+        return;
+    }
+    AssetSlot &slot = found->second;
+    if (job.data == NULL) {
+        SDL_Log("Failed to load %s in the background: %s\n", job.name.c_str(), job.error.c_str());
+        slot.state = AssetState::FAILED;
+        return;
+    }
+
+    if (is_image) {
+        slot.asset = addImage(job.name, static_cast<SDL_Surface*>(job.data));
+    } else {
+        Mix_Chunk *sound = static_cast<Mix_Chunk*>(job.data);
+        auto loaded = sound_map.insert({job.name, sound});
+        if (!loaded.second) {
+            Mix_FreeChunk(sound);
+        }
+        slot.asset = loaded.first->second;
+    }
+    slot.state = AssetState::READY;
+}
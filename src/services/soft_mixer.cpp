@@ -0,0 +1,349 @@
+//
+//  Copyright © 2018 Vande Griek, Eric. All rights reserved.
+//
+
+#include <algorithm>
+#include <cmath>
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+#include "soft_mixer.h"
+#include "xorshift.h"
+
+/**
+ Add samples scaled by the left and right gains into out, one at a time.
+ count is in floats and must be even.
+ */
+static void addScaledScalar(float *out, const float *in, int count, float left, float right) {
+    for (int idx = 0; idx < count; idx += 2) {
+        out[idx] += in[idx] * left;
+        out[idx + 1] += in[idx + 1] * right;
+    }
+}
+
+#ifdef __SSE2__
+/**
+ Add samples scaled by the left and right gains into out, several frames at a time.
+ Uses AVX when the build targets it, otherwise SSE.
+ */
+static void addScaledSimd(float *out, const float *in, int count, float left, float right) {
+    int idx = 0;
+#ifdef __AVX__
+    __m256 gain8 = _mm256_setr_ps(left, right, left, right, left, right, left, right);
+    for (; idx + 8 <= count; idx += 8) {
+        __m256 sum = _mm256_add_ps(_mm256_loadu_ps(out + idx), _mm256_mul_ps(_mm256_loadu_ps(in + idx), gain8));
+        _mm256_storeu_ps(out + idx, sum);
+    }
+#endif
+    __m128 gain4 = _mm_setr_ps(left, right, left, right);
+    for (; idx + 4 <= count; idx += 4) {
+        __m128 sum = _mm_add_ps(_mm_loadu_ps(out + idx), _mm_mul_ps(_mm_loadu_ps(in + idx), gain4));
+        _mm_storeu_ps(out + idx, sum);
+    }
+    addScaledScalar(out + idx, in + idx, count - idx, left, right);
+}
+#endif
+
+/**
+ Mix count floats of every voice into out, replacing what was there.
+ Voices that reach their end are removed by moving the last voice into their place.
+ */
+void mixVoices(float *out, int count, SoftVoice *voices, int &voice_count, bool use_simd) {
+    std::fill(out, out + count, 0.0f);
+    int idx = 0;
+    while (idx < voice_count) {
+        SoftVoice &voice = voices[idx];
+        int len = int(std::min<Uint32>(count, voice.length - voice.pos));
+#ifdef __SSE2__
+        if (use_simd) {
+            addScaledSimd(out, voice.samples + voice.pos, len, voice.left, voice.right);
+        } else {
+            addScaledScalar(out, voice.samples + voice.pos, len, voice.left, voice.right);
+        }
+#else
+        addScaledScalar(out, voice.samples + voice.pos, len, voice.left, voice.right);
+#endif
+        voice.pos += len;
+        if (voice.pos >= voice.length) {
+            voice = voices[--voice_count];
+        } else {
+            ++idx;
+        }
+    }
+}
+
+/**
+ Add mixed floats to the samples SDL_mixer produced, clipping to the range of Sint16
+ */
+void addToStream(Sint16 *stream, const float *mix, int count, bool use_simd) {
+    int idx = 0;
+#ifdef __SSE2__
+    if (use_simd) {
+        for (; idx + 8 <= count; idx += 8) {
+            __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(stream + idx));
+            // sign extend each half to 32 bits
+            __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16));
+            __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16));
+            lo = _mm_add_ps(lo, _mm_loadu_ps(mix + idx));
+            hi = _mm_add_ps(hi, _mm_loadu_ps(mix + idx + 4));
+            // packing saturates, which does the clipping
+            __m128i out = _mm_packs_epi32(_mm_cvtps_epi32(lo), _mm_cvtps_epi32(hi));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(stream + idx), out);
+        }
+    }
+#endif
+    for (; idx < count; ++idx) {
+        // rounds to nearest like the SIMD conversion
+        float sample = std::nearbyint(stream[idx] + mix[idx]);
+        stream[idx] = Sint16(std::max(-32768.0f, std::min(32767.0f, sample)));
+    }
+}
+
+/**
+ Start mixing sound effects.
+ The audio device has to be open already with buffers of buffer_samples, and has to be 16 bit stereo.
+ Returns false if the software mixer can't be used.
+ */
+bool SoftMixer::init(int buffer_samples) {
+    int frequency, channels;
+    Uint16 format;
+    if (Mix_QuerySpec(&frequency, &format, &channels) == 0) {
+        SDL_Log("Software mixer needs the audio device to be open\n");
+        return false;
+    }
+    if (format != AUDIO_S16SYS || channels != 2) {
+        SDL_Log("Software mixer only supports 16 bit stereo, not using it\n");
+        return false;
+    }
+
+    buffers_mixed = 0;
+    peak_voices = 0;
+    voices_dropped = 0;
+    mix_ticks = 0;
+    max_mix_ticks = 0;
+    voice_count = 0;
+    attach(buffer_samples);
+    enabled = true;
+
+#if defined(__AVX__)
+    SDL_Log("Mixing sound effects in software with AVX\n");
+#elif defined(__SSE2__)
+    SDL_Log("Mixing sound effects in software with SSE2\n");
+#else
+    SDL_Log("Mixing sound effects in software\n");
+#endif
+    return true;
+}
+
+/**
+ Hook into SDL_mixer's output, again after the audio device is reopened.
+ The mixing space is sized for buffer_samples here, so the device thread never allocates.
+ */
+void SoftMixer::attach(int buffer_samples) {
+    // waits for the device thread to finish the current buffer, so the mixing space can change
+    Mix_SetPostMix(NULL, NULL);
+    Uint16 format;
+    int channels = 2;
+    Mix_QuerySpec(&frequency, &format, &channels);
+    this->buffer_samples = buffer_samples;
+    mix_buffer.assign(std::max(SOFT_MIXER_BUFFER_FLOATS, buffer_samples * channels), 0.0f);
+    Mix_SetPostMix(&SoftMixer::postMix, this);
+}
+
+/**
+ Stop mixing and free the converted sounds
+ */
+void SoftMixer::shutdown() {
+    if (!enabled) {
+        return;
+    }
+    // waits for the device thread to finish the current buffer
+    Mix_SetPostMix(NULL, NULL);
+    enabled = false;
+    samples.clear();
+    retired.clear();
+    voice_count = 0;
+}
+
+/**
+ Start playing a sound. Called from the audio thread.
+ The sound is converted to floats the first time it is played.
+ id is used to stop the voice, it should be different for every voice.
+ Returns false if the sound couldn't be started.
+ */
+bool SoftMixer::play(SoundId sound, const Mix_Chunk *chunk, float left, float right, Uint32 id) {
+    if (!retired.empty()) {
+        Uint32 now = SDL_GetTicks();
+        retired.erase(std::remove_if(retired.begin(), retired.end(),
+                                     [now](const std::pair<Uint32, std::vector<float>> &item) {
+                                         return Sint32(now - item.first) >= 0;
+                                     }),
+                      retired.end());
+    }
+    if (sound >= SoundId(samples.size())) {
+        // moving the converted sounds doesn't move their data, so playing voices are fine
+        samples.resize(sound + 1);
+    }
+    std::vector<float> &converted = samples[sound];
+    if (converted.empty()) {
+        // chunks are already in the device format, 16 bit stereo
+        const Sint16 *data = reinterpret_cast<const Sint16*>(chunk->abuf);
+        converted.assign(data, data + chunk->alen / sizeof(Sint16) / 2 * 2);
+    }
+    if (converted.empty()) {
+        return false;
+    }
+
+    if (!starts.push({converted.data(), Uint32(converted.size()), 0, left, right, id})) {
+        ++voices_dropped;
+        return false;
+    }
+    return true;
+}
+
+/**
+ Stop a voice started with play(), such as to make room for a more important one.
+ Called from the audio thread. Nothing happens if the voice has already finished.
+ Returns false if the stop couldn't be queued.
+ */
+bool SoftMixer::stop(Uint32 id) {
+    return stops.push(id);
+}
+
+/**
+ Drop the converted copy of a sound, such as when the sound is unloaded,
+ so it is converted again from the new chunk if it is loaded and played again.
+ Called from the audio thread. Voices may still be playing the copy,
+ so it is kept until it is long enough after now that they have finished.
+ */
+void SoftMixer::forget(SoundId sound) {
+    if (sound >= SoundId(samples.size()) || samples[sound].empty()) {
+        return;
+    }
+    // started voices reach the device within a buffer, and the device mixes ahead of time
+    Uint32 frames = Uint32(samples[sound].size() / 2);
+    Uint32 free_after = SDL_GetTicks() + Uint32((Uint64(frames) + 2 * buffer_samples) * 1000 / frequency) + 1;
+    retired.push_back({free_after, std::vector<float>()});
+    retired.back().second.swap(samples[sound]);
+}
+
+/**
+ Take the voice with the given id out of the voices being mixed, if it is there
+ */
+void SoftMixer::removeVoice(Uint32 id) {
+    for (int idx = 0; idx < voice_count; ++idx) {
+        if (voices[idx].id == id) {
+            voices[idx] = voices[--voice_count];
+            return;
+        }
+    }
+}
+
+/**
+ SDL_mixer calls this on the device thread with the buffer it has mixed music and channels into
+ */
+void SoftMixer::postMix(void *udata, Uint8 *stream, int len) {
+    static_cast<SoftMixer*>(udata)->mix(reinterpret_cast<Sint16*>(stream), len / int(sizeof(Sint16)));
+}
+
+/**
+ Mix every playing voice into the device buffer
+ */
+void SoftMixer::mix(Sint16 *stream, int count) {
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    // voices are stopped before new ones start, to make room for them.
+    // a voice can be stopped before it was started, so the stops are kept until the starts are read
+    Uint32 stopped[SOFT_MIXER_QUEUE_SIZE];
+    int stop_count = 0;
+    while (stop_count < int(SOFT_MIXER_QUEUE_SIZE) && stops.pop(stopped[stop_count])) {
+        removeVoice(stopped[stop_count++]);
+    }
+    SoftVoice voice;
+    while (starts.pop(voice)) {
+        if (std::find(stopped, stopped + stop_count, voice.id) != stopped + stop_count) {
+            continue;
+        }
+        if (voice_count == SOFT_MIXER_VOICES) {
+            ++voices_dropped;
+            continue;
+        }
+        voices[voice_count++] = voice;
+    }
+    if (voice_count == 0) {
+        return;
+    }
+    // the mixing space was sized for the device buffer, allocating here could stall the device.
+    // if the device gave a bigger buffer anyway, sound effects are only mixed into the start of it
+    count = std::min(count, int(mix_buffer.size()));
+    if (Uint32(voice_count) > peak_voices) {
+        peak_voices = voice_count;
+    }
+
+    mixVoices(mix_buffer.data(), count, voices, voice_count, true);
+    addToStream(stream, mix_buffer.data(), count, true);
+
+    Uint64 ticks = SDL_GetPerformanceCounter() - start;
+    mix_ticks += ticks;
+    if (ticks > max_mix_ticks) {
+        max_mix_ticks = ticks;
+    }
+    ++buffers_mixed;
+}
+
+/**
+ Get how long mixing has taken so far
+ */
+SoftMixerStats SoftMixer::getStats() {
+    double ms_per_tick = 1000.0 / SDL_GetPerformanceFrequency();
+    SoftMixerStats stats;
+    stats.buffers = buffers_mixed;
+    stats.peak_voices = peak_voices;
+    stats.dropped = voices_dropped;
+    stats.avg_ms = stats.buffers > 0 ? mix_ticks * ms_per_tick / stats.buffers : 0;
+    stats.max_ms = max_mix_ticks * ms_per_tick;
+    return stats;
+}
+
+/**
+ Time mixing voice_count voices into buffers of SOFT_MIXER_BENCH_FRAMES frames,
+ with the scalar code and with SIMD, and write the results to the log.
+ */
+void benchmarkSoftMixer(int voice_count, int buffers) {
+    int count = SOFT_MIXER_BENCH_FRAMES * 2;
+    // long enough that no voice ends during the run
+    std::vector<float> sound(size_t(buffers + 1) * count * 2);
+    XorShift noise(2463534242u);
+    for (float &sample : sound) {
+        sample = float(Sint16(noise.next()));
+    }
+
+    std::vector<float> mix(count);
+    std::vector<Sint16> stream(count);
+    std::vector<SoftVoice> voices(voice_count);
+    for (bool use_simd : {false, true}) {
+#ifndef __SSE2__
+        if (use_simd) {
+            SDL_Log("No SIMD support in this build\n");
+            break;
+        }
+#endif
+        for (int idx = 0; idx < voice_count; ++idx) {
+            // start the voices at different places so they don't all line up
+            voices[idx] = {sound.data(), Uint32(sound.size()), Uint32(idx % SOFT_MIXER_BENCH_FRAMES) * 2,
+                           1.0f / voice_count, 0.5f / voice_count, Uint32(idx)};
+        }
+        std::fill(stream.begin(), stream.end(), 0);
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int buf = 0; buf < buffers; ++buf) {
+            int playing = voice_count;
+            mixVoices(mix.data(), count, voices.data(), playing, use_simd);
+            addToStream(stream.data(), mix.data(), count, use_simd);
+        }
+        double elapsed_ms = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+        SDL_Log("%s: %.4f ms per %d frame buffer with %d voices (checksum %d)\n",
+                use_simd ? "SIMD" : "Scalar", elapsed_ms / buffers, SOFT_MIXER_BENCH_FRAMES, voice_count,
+                int(stream[count / 2]));
+    }
+}
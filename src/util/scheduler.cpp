@@ -0,0 +1,79 @@
+//
+//  Copyright © 2018 Vande Griek, Eric. All rights reserved.
+//
+
+#include "scheduler.h"
+
+/**
+ Add a task that runs on the first update after interval ms have passed, or every update if interval is 0.
+ budget_ms is how long a run is expected to take at most.
+ */
+void Scheduler::add(const std::string &name, int interval, float budget_ms, std::function<void(int)> run) {
+    ScheduledTask task;
+    task.name = name;
+    task.interval = interval;
+    // start part way through the interval, further for each task added
+    task.pending = interval > 0 ? int(tasks.size()) * SCHEDULER_STAGGER_MS % interval : 0;
+    task.budget_ms = budget_ms;
+    task.run = run;
+    task.runs = 0;
+    task.over_budget = 0;
+    task.total_ticks = 0;
+    task.max_ticks = 0;
+    tasks.push_back(task);
+}
+
+/**
+ Run every task whose interval has passed, delta is the ms since the last update
+ */
+void Scheduler::update(int delta) {
+    ++updates;
+    Uint64 budget_scale = SDL_GetPerformanceFrequency();
+    for (ScheduledTask &task : tasks) {
+        task.pending += delta;
+        if (task.pending < task.interval) {
+            continue;
+        }
+        Uint64 start = SDL_GetPerformanceCounter();
+        task.run(task.pending);
+        Uint64 ticks = SDL_GetPerformanceCounter() - start;
+        task.pending = 0;
+
+        ++task.runs;
+        task.total_ticks += ticks;
+        if (ticks > task.max_ticks) {
+            task.max_ticks = ticks;
+        }
+        if (ticks * 1000.0f > task.budget_ms * budget_scale) {
+            ++task.over_budget;
+        }
+    }
+}
+
+/**
+ Write how often each task ran and how long it took to the log
+ */
+void Scheduler::logStats() {
+    float ms_per_tick = 1000.0f / SDL_GetPerformanceFrequency();
+    SDL_Log("Timing over %d updates:\n", updates);
+    for (const ScheduledTask &task : tasks) {
+        float avg_ms = task.runs > 0 ? task.total_ticks * ms_per_tick / task.runs : 0.0f;
+        float frame_ms = updates > 0 ? task.total_ticks * ms_per_tick / updates : 0.0f;
+        SDL_Log("  %-10s %6d runs, %.3f ms avg, %.3f ms max, %.3f ms per update, %d over %.2f ms budget\n",
+                task.name.c_str(), task.runs, avg_ms, task.max_ticks * ms_per_tick, frame_ms,
+                task.over_budget, task.budget_ms);
+    }
+}
+
+/**
+ Start counting again from zero
+ */
+void Scheduler::resetStats() {
+    updates = 0;
+    for (ScheduledTask &task : tasks) {
+        task.runs = 0;
+        task.over_budget = 0;
+        task.total_ticks = 0;
+        task.max_ticks = 0;
+    }
+}
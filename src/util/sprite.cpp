@@ -7,10 +7,11 @@
 
 /**
  Set up this sprite based on the frame_config struct that defines
- the parts of the sprite sheet to use for each sprite state
+ the parts of the sprite sheet to use for each sprite state.
+ frame_config isn't copied, it has to outlive the sprite.
  */
-void Sprite::init(FrameConfig frame_config) {
-    this->frame_config = frame_config;
+void Sprite::init(const FrameConfig &frame_config) {
+    this->frame_config = &frame_config;
     setState(SpriteState::IDLE);
 }
 
@@ -27,20 +28,20 @@ void Sprite::setState(SpriteState state) {
     current_state = state;
 
     if (state == SpriteState::IDLE) {
-        frame_start = frame_config.idle_frame_start;
-        frame_count = frame_config.idle_frame_final - frame_config.idle_frame_start + 1;
+        frame_start = frame_config->idle_frame_start;
+        frame_count = frame_config->idle_frame_final - frame_config->idle_frame_start + 1;
     } else if (state == SpriteState::WALKING) {
-        frame_start = frame_config.walking_frame_start;
-        frame_count = frame_config.walking_frame_final - frame_config.walking_frame_start + 1;
+        frame_start = frame_config->walking_frame_start;
+        frame_count = frame_config->walking_frame_final - frame_config->walking_frame_start + 1;
     } else if (state == SpriteState::JUMPING) {
-        frame_start = frame_config.jumping_frame_start;
-        frame_count = frame_config.jumping_frame_final - frame_config.jumping_frame_start + 1;
+        frame_start = frame_config->jumping_frame_start;
+        frame_count = frame_config->jumping_frame_final - frame_config->jumping_frame_start + 1;
     } else if (state == SpriteState::BRAKING) {
-        frame_start = frame_config.braking_frame_start;
-        frame_count = frame_config.braking_frame_final - frame_config.braking_frame_start + 1;
+        frame_start = frame_config->braking_frame_start;
+        frame_count = frame_config->braking_frame_final - frame_config->braking_frame_start + 1;
     } else if (state == SpriteState::DEAD) {
-        frame_start = frame_config.dead_frame_start;
-        frame_count = frame_config.dead_frame_final - frame_config.dead_frame_start + 1;
+        frame_start = frame_config->dead_frame_start;
+        frame_count = frame_config->dead_frame_final - frame_config->dead_frame_start + 1;
     }
     setFrame(frame_start);
     start_time = SDL_GetTicks();